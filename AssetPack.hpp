@@ -0,0 +1,306 @@
+#ifndef ASSET_PACK_HPP
+#define ASSET_PACK_HPP
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+#include "Variable.hpp"
+#include "MappedFile.hpp"
+#ifndef STBI_INCLUDE_STB_IMAGE_H
+#include "stb_image.h" // solo dichiarazioni: l'implementazione la include TextureLoader.hpp, una volta
+#endif
+
+// ---------- ASSET PACK ----------
+// Un unico file con tutte le texture e i livelli (prodotto da assetpack): si apre e si
+// mappa una volta all'avvio invece di aprire centinaia di file piccoli. Gli asset si
+// cercano per path ("texture/block/erba.png", "levels/exterior.lvlb") con una ricerca
+// binaria nella tabella dei contenuti, ordinata per nome. Ogni voce può essere
+// compressa (LZ, vedi Compress): si comprimono solo i file che ci guadagnano, le PNG
+// restano come sono e si leggono direttamente dalla mappatura.
+// Senza pacchetto, o per un asset che non contiene, si leggono i file sciolti.
+// Senza ASSET_PACK_RELEASE vince anche il file sciolto modificato dopo il pacchetto,
+// così in sviluppo non serve rigenerarlo a ogni modifica.
+//
+// Struttura: Header, dati delle voci (allineati a 16 byte), Entry[entryCount] ordinate
+// per nome, nomi (non terminati, nameOffset/nameLength). Byte order nativo.
+// La lettura è sola lettura sulla mappatura: dopo Open si può usare da qualsiasi thread.
+namespace AssetPack {
+
+    const char MAGIC[4] = {'T', 'W', 'P', 'K'};
+    const uint32_t VERSION = 1;
+    const uint32_t ENDIAN_TAG = 0x01020304u;
+    const size_t DATA_ALIGN = 16; // i record dei livelli compilati si leggono sul posto
+    const uint64_t MAX_EXPANSION = 255; // ogni byte compresso produce al massimo 255 byte (lunghezze estese)
+
+    enum Compression : uint32_t {
+        STORED = 0,
+        LZ = 1
+    };
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t endianTag;
+        uint32_t entryCount;
+        uint64_t tocOffset;     // Entry[entryCount]
+        uint64_t namesOffset;
+        uint64_t namesBytes;
+    };
+
+    struct Entry {
+        uint64_t dataOffset;
+        uint64_t storedSize;    // byte nel pacchetto
+        uint64_t size;          // byte dopo la decompressione
+        uint32_t nameOffset;    // nella tabella dei nomi
+        uint32_t nameLength;
+        uint32_t compression;   // Compression
+        uint32_t reserved;
+    };
+
+    // ---------- COMPRESSIONE LZ ----------
+    // Formato a sequenze (come LZ4): token [4 bit letterali | 4 bit match - MIN_MATCH],
+    // lunghezze estese con byte da 255, letterali, offset a 16 bit. L'ultima sequenza ha
+    // solo letterali. Veloce da decomprimere, nessuna dipendenza esterna.
+    const size_t MIN_MATCH = 4;
+    const size_t MAX_OFFSET = 65535;
+
+    // Usata da assetpack (offline)
+    inline std::vector<unsigned char> Compress(const unsigned char* in, size_t size) {
+        const int HASH_BITS = 14;
+        std::vector<unsigned char> out;
+        out.reserve(size / 2 + 16);
+        std::vector<int64_t> table(size_t(1) << HASH_BITS, -1); // ultima posizione di ogni hash di 4 byte
+
+        auto putLength = [&out](size_t length) {
+            for (; length >= 255; length -= 255) out.push_back(255);
+            out.push_back(uint8_t(length));
+        };
+        size_t anchor = 0; // primo letterale non ancora scritto
+        auto putSequence = [&](size_t literalEnd, size_t matchLength, size_t offset) {
+            size_t literals = literalEnd - anchor;
+            uint8_t token = uint8_t(std::min<size_t>(literals, 15) << 4);
+            if (matchLength) token |= uint8_t(std::min<size_t>(matchLength - MIN_MATCH, 15));
+            out.push_back(token);
+            if (literals >= 15) putLength(literals - 15);
+            out.insert(out.end(), in + anchor, in + literalEnd);
+            if (matchLength) {
+                out.push_back(uint8_t(offset & 0xFF));
+                out.push_back(uint8_t(offset >> 8));
+                if (matchLength - MIN_MATCH >= 15) putLength(matchLength - MIN_MATCH - 15);
+            }
+        };
+
+        size_t i = 0;
+        while (i + MIN_MATCH <= size) {
+            uint32_t sequence;
+            std::memcpy(&sequence, in + i, 4);
+            uint32_t hash = (sequence * 2654435761u) >> (32 - HASH_BITS);
+            int64_t candidate = table[hash];
+            table[hash] = int64_t(i);
+            if (candidate >= 0 && i - size_t(candidate) <= MAX_OFFSET &&
+                std::memcmp(in + candidate, in + i, MIN_MATCH) == 0) {
+                size_t length = MIN_MATCH;
+                while (i + length < size && in[candidate + length] == in[i + length]) length++;
+                putSequence(i, length, i - size_t(candidate));
+                i += length;
+                anchor = i;
+            } else {
+                i++;
+            }
+        }
+        putSequence(size, 0, 0);
+        return out;
+    }
+
+    // Controlla ogni lunghezza e offset: un pacchetto corrotto non scrive fuori da out
+    inline bool Decompress(const unsigned char* in, size_t inSize, unsigned char* out, size_t outSize) {
+        const unsigned char* ip = in;
+        const unsigned char* const inEnd = in + inSize;
+        size_t op = 0;
+
+        auto getLength = [&ip, inEnd](size_t& length) {
+            for (;;) {
+                if (ip == inEnd) return false;
+                uint8_t b = *ip++;
+                length += b;
+                if (b != 255) return true;
+            }
+        };
+
+        while (ip < inEnd) {
+            uint8_t token = *ip++;
+            size_t literals = token >> 4;
+            if (literals == 15 && !getLength(literals)) return false;
+            if (size_t(inEnd - ip) < literals || outSize - op < literals) return false;
+            std::memcpy(out + op, ip, literals);
+            ip += literals;
+            op += literals;
+            if (ip == inEnd) break; // ultima sequenza: solo letterali
+
+            if (inEnd - ip < 2) return false;
+            size_t offset = size_t(ip[0]) | (size_t(ip[1]) << 8);
+            ip += 2;
+            size_t length = token & 15;
+            if (length == 15 && !getLength(length)) return false;
+            length += MIN_MATCH;
+            if (offset == 0 || offset > op || outSize - op < length) return false;
+            for (size_t k = 0; k < length; k++, op++) out[op] = out[op - offset]; // può sovrapporsi
+        }
+        return op == outSize;
+    }
+
+    // ---------- LETTURA ----------
+    // Contenuto di un asset: punta nella mappatura (STORED) o nel buffer decompresso
+    struct Asset {
+        const unsigned char* data = nullptr;
+        size_t size = 0;
+        std::vector<unsigned char> buffer;
+    };
+
+    static MappedFile packFile;
+    static const Entry* packEntries = nullptr;
+    static uint32_t packEntryCount = 0;
+    static const char* packNames = nullptr;
+    static std::filesystem::file_time_type packTime; // ultima modifica del pacchetto
+
+    inline std::string EntryName(const Entry& e) {
+        return std::string(packNames + e.nameOffset, e.nameLength);
+    }
+
+    // I path arrivano con separatori e prefissi diversi ("levels\x.txt", "./texture/..")
+    inline std::string NormalizeName(std::string name) {
+        std::replace(name.begin(), name.end(), '\\', '/');
+        while (name.compare(0, 2, "./") == 0) name.erase(0, 2);
+        return name;
+    }
+
+    inline void Close() {
+        packFile.close();
+        packEntries = nullptr;
+        packEntryCount = 0;
+        packNames = nullptr;
+    }
+
+    // Mappa il pacchetto e ne valida l'indice. false (file sciolti) se manca o non è valido.
+    inline bool Open(const std::string& path) {
+        Close();
+        if (path.empty() || !packFile.open(path)) return false;
+        const unsigned char* base = packFile.data();
+        const size_t size = packFile.size();
+
+        auto reject = [&path](const char* reason) {
+            std::cerr << "Pacchetto " << path << " ignorato: " << reason << std::endl;
+            Close();
+            return false;
+        };
+        if (size < sizeof(Header)) return reject("file troppo corto");
+        Header h;
+        std::memcpy(&h, base, sizeof(h));
+        if (std::memcmp(h.magic, MAGIC, 4) != 0) return reject("non e' un pacchetto");
+        if (h.endianTag != ENDIAN_TAG) return reject("byte order diverso");
+        if (h.version != VERSION) return reject("versione non supportata");
+        if (h.tocOffset % alignof(Entry) != 0 || h.tocOffset > size ||
+            uint64_t(h.entryCount) * sizeof(Entry) > size - h.tocOffset ||
+            h.namesOffset > size || h.namesBytes > size - h.namesOffset) return reject("indice fuori dal file");
+
+        const Entry* entries = reinterpret_cast<const Entry*>(base + h.tocOffset);
+        const char* names = reinterpret_cast<const char*>(base + h.namesOffset);
+        for (uint32_t i = 0; i < h.entryCount; i++) {
+            const Entry& e = entries[i];
+            if (uint64_t(e.nameOffset) + e.nameLength > h.namesBytes) return reject("nome fuori tabella");
+            if (e.dataOffset > size || e.storedSize > size - e.dataOffset) return reject("dati fuori dal file");
+            if (e.compression != STORED && e.compression != LZ) return reject("compressione sconosciuta");
+            if (e.compression == STORED && e.storedSize != e.size) return reject("dimensione incoerente");
+            if (e.compression == LZ && e.size > e.storedSize * MAX_EXPANSION) return reject("dimensione incoerente");
+            if (i > 0) { // la ricerca binaria richiede nomi ordinati e unici
+                const Entry& p = entries[i - 1];
+                int cmp = std::memcmp(names + p.nameOffset, names + e.nameOffset, std::min(p.nameLength, e.nameLength));
+                if (cmp > 0 || (cmp == 0 && p.nameLength >= e.nameLength)) return reject("indice non ordinato");
+            }
+        }
+        std::error_code error;
+        packTime = std::filesystem::last_write_time(path, error);
+        packEntries = entries;
+        packEntryCount = h.entryCount;
+        packNames = names;
+        std::cout << "Pacchetto asset: " << path << " (" << packEntryCount << " file)" << std::endl;
+        return true;
+    }
+
+    inline bool IsOpen() { return packEntries != nullptr; }
+
+    // Il file sciolto è stato modificato dopo il pacchetto (sempre false con ASSET_PACK_RELEASE)
+    inline bool LooseIsNewer(const std::string& filename) {
+        if (ASSET_PACK_RELEASE || !packEntries) return false;
+        std::error_code error;
+        std::filesystem::file_time_type looseTime = std::filesystem::last_write_time(filename, error);
+        return !error && looseTime > packTime;
+    }
+
+    // Voce con quel nome, nullptr se il pacchetto non la contiene o se il file sciolto è più recente
+    inline const Entry* Find(const std::string& filename) {
+        if (!packEntries || LooseIsNewer(filename)) return nullptr;
+        const std::string name = NormalizeName(filename);
+        const Entry* end = packEntries + packEntryCount;
+        const Entry* it = std::lower_bound(packEntries, end, name, [](const Entry& e, const std::string& key) {
+            return key.compare(0, key.size(), packNames + e.nameOffset, e.nameLength) > 0;
+        });
+        if (it == end || name.compare(0, name.size(), packNames + it->nameOffset, it->nameLength) != 0) return nullptr;
+        return it;
+    }
+
+    inline bool Contains(const std::string& filename) { return Find(filename) != nullptr; }
+
+    // Legge l'asset dal pacchetto; false se non c'è (o è corrotto): si usa il file sciolto
+    inline bool Read(const std::string& filename, Asset& out) {
+        const Entry* e = Find(filename);
+        if (!e) return false;
+        const unsigned char* stored = packFile.data() + e->dataOffset;
+        if (e->compression == STORED) {
+            out.buffer.clear();
+            out.data = stored;
+            out.size = size_t(e->size);
+            return true;
+        }
+        out.buffer.resize(size_t(e->size));
+        if (!Decompress(stored, size_t(e->storedSize), out.buffer.data(), out.buffer.size())) {
+            std::cerr << "Pacchetto: voce corrotta " << filename << std::endl;
+            out.buffer.clear();
+            return false;
+        }
+        out.data = out.buffer.data();
+        out.size = out.buffer.size();
+        return true;
+    }
+
+    // Nomi (ordinati) dei file direttamente dentro folder, come un directory_iterator
+    inline std::vector<std::string> List(const std::string& folder) {
+        std::vector<std::string> names;
+        if (!packEntries) return names;
+        std::string prefix = NormalizeName(folder);
+        if (!prefix.empty() && prefix.back() != '/') prefix += '/';
+        for (uint32_t i = 0; i < packEntryCount; i++) {
+            std::string name = EntryName(packEntries[i]);
+            if (name.compare(0, prefix.size(), prefix) != 0) continue;
+            if (name.find('/', prefix.size()) != std::string::npos) continue; // sottocartella
+            names.push_back(name);
+        }
+        return names;
+    }
+
+    // stbi_load dal pacchetto o dal file sciolto (liberare con stbi_image_free)
+    inline unsigned char* LoadPixels(const std::string& filename, int* width, int* height, int* channels, int desired) {
+        Asset asset;
+        if (Read(filename, asset)) {
+            return stbi_load_from_memory(asset.data, int(asset.size), width, height, channels, desired);
+        }
+        return stbi_load(filename.c_str(), width, height, channels, desired);
+    }
+
+} // namespace AssetPack
+
+#endif // ASSET_PACK_HPP
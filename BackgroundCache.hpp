@@ -0,0 +1,111 @@
+#ifndef BACKGROUND_CACHE_HPP
+#define BACKGROUND_CACHE_HPP
+
+#include <GL/glew.h>
+#include "GLState.hpp"
+
+// ---------- BACKGROUND CACHE ----------
+// La parte statica della scena (tile ed eventualmente decorazioni) viene disegnata
+// una sola volta in un framebuffer offscreen; nei frame successivi basta un quad.
+// Senza FBO (GL 2.1 senza ARB_framebuffer_object) si usa una display list.
+struct BackgroundCache {
+    GLuint fbo = 0, texture = 0;   // percorso FBO
+    GLuint displayList = 0;        // fallback
+    int width = 0, height = 0;     // dimensione del target offscreen
+    int level = -1;                // livello attualmente in cache (-1 = nessuno)
+    bool fboFailed = false;        // FBO incompleto: si resta sulla display list
+
+    bool fboSupported() const {
+        return !fboFailed && (GLEW_VERSION_3_0 || GLEW_ARB_framebuffer_object);
+    }
+
+    void invalidate() { level = -1; }
+
+    // Disegna la cache del livello lvl; se non è valida la ricostruisce chiamando renderStatic()
+    template <typename RenderFn>
+    void draw(int lvl, RenderFn renderStatic) {
+        if (!fboSupported()) {
+            // la cache di stato non vale dentro una display list: ogni chiamata va registrata
+            if (level != lvl) {
+                if (!displayList) displayList = glGenLists(1);
+                TextureRender::InvalidateState();
+                glNewList(displayList, GL_COMPILE);
+                renderStatic();
+                glEndList();
+                level = lvl;
+            }
+            glCallList(displayList);
+            TextureRender::InvalidateState();
+            return;
+        }
+
+        GLint viewport[4];
+        GLint previousFbo = 0;
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFbo);
+        if (viewport[2] != width || viewport[3] != height) {
+            release();
+            if (!createTarget(viewport[2], viewport[3], previousFbo)) {
+                draw(lvl, renderStatic); // ripiega sulla display list
+                return;
+            }
+        }
+
+        if (level != lvl) {
+            glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+            glViewport(0, 0, width, height);
+            glClear(GL_COLOR_BUFFER_BIT);
+            renderStatic();
+            glBindFramebuffer(GL_FRAMEBUFFER, previousFbo);
+            glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+            level = lvl;
+        }
+
+        // il contenuto è già composto: niente blending sul quad finale
+        TextureRender::Disable(GL_BLEND);
+        TextureRender::BindTexture(texture);
+        glBegin(GL_QUADS);
+            glTexCoord2f(0.0f, 0.0f); glVertex2f(-1.0f, -1.0f);
+            glTexCoord2f(1.0f, 0.0f); glVertex2f( 1.0f, -1.0f);
+            glTexCoord2f(1.0f, 1.0f); glVertex2f( 1.0f,  1.0f);
+            glTexCoord2f(0.0f, 1.0f); glVertex2f(-1.0f,  1.0f);
+        glEnd();
+        TextureRender::Enable(GL_BLEND);
+    }
+
+    void release() {
+        if (fbo) glDeleteFramebuffers(1, &fbo);
+        if (texture) TextureRender::DeleteTextures(1, &texture);
+        if (displayList) glDeleteLists(displayList, 1);
+        fbo = texture = displayList = 0;
+        width = height = 0;
+        level = -1;
+    }
+
+private:
+    bool createTarget(int w, int h, GLint previousFbo) {
+        width = w;
+        height = h;
+        glGenTextures(1, &texture);
+        TextureRender::BindTexture(texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+        bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindFramebuffer(GL_FRAMEBUFFER, previousFbo);
+        level = -1;
+        if (!complete) {
+            release();
+            fboFailed = true;
+        }
+        return complete;
+    }
+};
+
+#endif // BACKGROUND_CACHE_HPP
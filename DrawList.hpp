@@ -0,0 +1,115 @@
+#ifndef DRAW_LIST_HPP
+#define DRAW_LIST_HPP
+
+#include <GL/glew.h>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include "TextureLoader.hpp"
+
+// ---------- DRAW COMMAND ----------
+// Comando di disegno POD: niente closure né stringhe, quindi nessuna allocazione per oggetto.
+struct DrawCommand {
+    float sortKey;                        // Y di base: valori alti vengono disegnati prima (più indietro)
+    uint32_t order;                       // ordine di inserimento, rende l'ordinamento deterministico
+    TextureRender::TextureHandle texture;
+    float x0, y0, x1, y1;                 // quad in coordinate NDC
+    uint16_t frameX, frameY;              // cella dello sheet (0,0 per le texture intere)
+    uint16_t framesPerRow, framesPerCol;  // dimensioni dello sheet in celle (1x1 per le texture intere)
+};
+
+// UV della cella di un comando dentro la regione (texture singola o pagina dell'atlas)
+inline void FrameUV(const DrawCommand& c, const TextureAtlas::Region& r,
+                    float& u0, float& v0, float& u1, float& v1) {
+    float du = (r.u1 - r.u0) / c.framesPerRow;
+    float dv = (r.v1 - r.v0) / c.framesPerCol;
+    u0 = r.u0 + c.frameX * du;
+    v0 = r.v0 + c.frameY * dv;
+    u1 = u0 + du;
+    v1 = v0 + dv;
+}
+
+// ---------- DRAW LIST ----------
+// Buffer riutilizzato tra i frame: dopo il primo frame clear() non libera memoria,
+// quindi push/sort/submit non allocano più.
+struct DrawList {
+    struct Batch {
+        GLuint texture;
+        bool opaque;     // disegnato senza blending
+        GLint first;
+        GLsizei count;
+    };
+
+    std::vector<DrawCommand> commands;
+    std::vector<float> vertices; // x, y, u, v per vertice, riempito da submit()
+    std::vector<Batch> batches;
+
+    void clear() { commands.clear(); }
+
+    void push(float sortKey, TextureRender::TextureHandle texture,
+              float x0, float y0, float x1, float y1,
+              int frameX = 0, int frameY = 0, int framesPerRow = 1, int framesPerCol = 1) {
+        commands.push_back(DrawCommand{sortKey, uint32_t(commands.size()), texture,
+                                       x0, y0, x1, y1,
+                                       uint16_t(frameX), uint16_t(frameY),
+                                       uint16_t(framesPerRow), uint16_t(framesPerCol)});
+    }
+
+    void sort() {
+        std::sort(commands.begin(), commands.end(),
+                  [](const DrawCommand& a, const DrawCommand& b) {
+                      if (a.sortKey != b.sortKey) return a.sortKey > b.sortKey;
+                      return a.order < b.order;
+                  });
+    }
+
+    // Disegna i comandi in ordine; quelli consecutivi sulla stessa texture GL
+    // (stessa pagina dell'atlas) diventano un solo glDrawArrays.
+    // L'ordine per Y resta quello del painter: le texture opache spengono solo il blending.
+    // È anche il fallback di SpriteRenderer quando l'instancing non è disponibile.
+    void submit() {
+        if (commands.empty()) return;
+
+        // 1. espande i comandi in vertici e raggruppa per texture
+        vertices.clear();
+        batches.clear();
+        for (const DrawCommand& c : commands) {
+            const TextureAtlas::Region& r = TextureRender::GetRegion(c.texture);
+            if (r.texture == 0) continue; // errore nel caricamento
+            if (batches.empty() || batches.back().texture != r.texture || batches.back().opaque != r.opaque) {
+                batches.push_back(Batch{r.texture, r.opaque, GLint(vertices.size() / 4), 0});
+            }
+            float tu0, tv0, tu1, tv1;
+            FrameUV(c, r, tu0, tv0, tu1, tv1);
+            // stesso ordine dei vertici di TextureRender::RenderTexture
+            const float quad[16] = {
+                c.x0, c.y0, tu0, tv1,
+                c.x1, c.y0, tu1, tv1,
+                c.x1, c.y1, tu1, tv0,
+                c.x0, c.y1, tu0, tv0
+            };
+            vertices.insert(vertices.end(), quad, quad + 16);
+            batches.back().count += 4;
+        }
+        if (batches.empty()) return;
+
+        // 2. un draw call per batch
+        const GLsizei stride = 4 * sizeof(float);
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glVertexPointer(2, GL_FLOAT, stride, vertices.data());
+        glTexCoordPointer(2, GL_FLOAT, stride, vertices.data() + 2);
+
+        for (const Batch& b : batches) {
+            TextureRender::SetEnabled(GL_BLEND, !b.opaque);
+            TextureRender::BindTexture(b.texture);
+            glDrawArrays(GL_QUADS, b.first, b.count);
+        }
+        TextureRender::Enable(GL_BLEND);
+
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
+    }
+};
+
+#endif // DRAW_LIST_HPP
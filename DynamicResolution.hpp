@@ -0,0 +1,180 @@
+#ifndef DYNAMIC_RESOLUTION_HPP
+#define DYNAMIC_RESOLUTION_HPP
+
+#include <GL/glew.h>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include "GLState.hpp"
+
+// ---------- DYNAMIC RESOLUTION ----------
+// La scena viene disegnata in un render target interno più piccolo della finestra e poi
+// riportata a schermo con un quad (filtro nearest o lineare). La scala si adatta al costo
+// misurato dei frame: scende quando si sfora il budget (1 / frame rate obiettivo) e risale
+// quando c'è margine. Il costo è il tempo GPU (timer query, GL 3.3 o ARB_timer_query) o,
+// senza query, il tempo CPU dall'inizio del rendering alla fine dello swap.
+// A scala piena si disegna direttamente nella finestra, senza copia.
+struct DynamicResolution {
+    typedef std::chrono::steady_clock Clock;
+
+    // controllo
+    float scale = 1.0f;
+    float minScale = 0.5f;
+    double budget = 1.0 / 60.0;     // secondi per frame
+    double smoothedCost = 0.0;      // media mobile del costo dei frame
+    int cooldown = 0;               // frame da attendere prima del prossimo cambio
+
+    // render target (allocato alla dimensione della finestra, si usa l'angolo in basso a sinistra)
+    GLuint fbo = 0, texture = 0;
+    int targetWidth = 0, targetHeight = 0;
+    bool fboFailed = false;
+    bool linearFilter = false;
+
+    // frame corrente
+    int windowWidth = 0, windowHeight = 0;
+    int renderWidth = 0, renderHeight = 0;
+    bool offscreen = false;
+
+    DynamicResolution(double targetFps, float minimumScale, bool linear)
+        : minScale(minimumScale), linearFilter(linear) {
+        budget = 1.0 / (targetFps > 0.0 ? targetFps : 60.0);
+    }
+
+    bool supported() const {
+        return !fboFailed && (GLEW_VERSION_3_0 || GLEW_ARB_framebuffer_object);
+    }
+
+    // Inizio frame: lega il target interno (se la scala è < 1) e imposta il viewport
+    void begin(int width, int height) {
+        frameStart = Clock::now();
+        windowWidth = width;
+        windowHeight = height;
+        if (!supported()) scale = 1.0f;
+
+        renderWidth = std::max(1, int(std::lround(width * scale)));
+        renderHeight = std::max(1, int(std::lround(height * scale)));
+        offscreen = renderWidth < width || renderHeight < height;
+        if (offscreen && (targetWidth != width || targetHeight != height)) {
+            release();
+            offscreen = createTarget(width, height);
+        }
+        if (!offscreen) {
+            renderWidth = width;
+            renderHeight = height;
+        }
+
+        if (timerQueriesSupported()) {
+            if (!queries[0]) glGenQueries(QUERY_COUNT, queries);
+            glBeginQuery(GL_TIME_ELAPSED, queries[queryFrame % QUERY_COUNT]);
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, offscreen ? fbo : 0);
+        glViewport(0, 0, renderWidth, renderHeight);
+    }
+
+    // Fine scena, prima dello swap: copia il target interno nella finestra
+    void resolve() {
+        if (offscreen) {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glViewport(0, 0, windowWidth, windowHeight);
+
+            // con il filtro lineare si resta mezzo texel dentro la zona disegnata
+            float inset = linearFilter ? 0.5f : 0.0f;
+            float u1 = (renderWidth - inset) / float(targetWidth);
+            float v1 = (renderHeight - inset) / float(targetHeight);
+            float u0 = inset / float(targetWidth);
+            float v0 = inset / float(targetHeight);
+
+            TextureRender::Disable(GL_BLEND);
+            TextureRender::BindTexture(texture);
+            glBegin(GL_QUADS);
+                glTexCoord2f(u0, v0); glVertex2f(-1.0f, -1.0f);
+                glTexCoord2f(u1, v0); glVertex2f( 1.0f, -1.0f);
+                glTexCoord2f(u1, v1); glVertex2f( 1.0f,  1.0f);
+                glTexCoord2f(u0, v1); glVertex2f(-1.0f,  1.0f);
+            glEnd();
+            TextureRender::Enable(GL_BLEND);
+        }
+        if (timerQueriesSupported()) glEndQuery(GL_TIME_ELAPSED);
+        renderEnd = Clock::now();
+    }
+
+    // Dopo lo swap: misura il costo del frame e aggiorna la scala
+    void frameDone() {
+        double cost = std::chrono::duration<double>(Clock::now() - frameStart).count();
+        if (timerQueriesSupported()) {
+            // la query di QUERY_COUNT-1 frame fa è pronta senza bloccare la pipeline
+            double cpu = std::chrono::duration<double>(renderEnd - frameStart).count();
+            cost = cpu;
+            queryFrame++;
+            GLuint oldest = queries[queryFrame % QUERY_COUNT];
+            if (queryFrame >= QUERY_COUNT) {
+                GLint available = 0;
+                glGetQueryObjectiv(oldest, GL_QUERY_RESULT_AVAILABLE, &available);
+                if (available) {
+                    GLuint64 gpuNs = 0;
+                    glGetQueryObjectui64v(oldest, GL_QUERY_RESULT, &gpuNs);
+                    cost = std::max(cpu, gpuNs * 1e-9);
+                }
+            }
+        }
+
+        smoothedCost = smoothedCost > 0.0 ? smoothedCost * 0.9 + cost * 0.1 : cost;
+        if (cooldown > 0) { cooldown--; return; }
+        if (!supported()) return;
+
+        // il costo cresce con l'area: passi piccoli verso l'alto, più decisi verso il basso
+        float previous = scale;
+        if (smoothedCost > budget * 0.95) scale = std::max(minScale, scale - 0.1f);
+        else if (smoothedCost < budget * 0.7) scale = std::min(1.0f, scale + 0.05f);
+        if (scale != previous) cooldown = 30; // lascia assestare la media prima di ricorreggere
+    }
+
+    void release() {
+        if (fbo) glDeleteFramebuffers(1, &fbo);
+        if (texture) TextureRender::DeleteTextures(1, &texture);
+        fbo = texture = 0;
+        targetWidth = targetHeight = 0;
+    }
+
+    void releaseQueries() {
+        if (queries[0]) glDeleteQueries(QUERY_COUNT, queries);
+        std::fill(queries, queries + QUERY_COUNT, 0u);
+    }
+
+private:
+    static constexpr int QUERY_COUNT = 3;
+    GLuint queries[QUERY_COUNT] = {0, 0, 0};
+    unsigned long queryFrame = 0;
+    Clock::time_point frameStart, renderEnd;
+
+    bool timerQueriesSupported() const {
+        return GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+    }
+
+    bool createTarget(int w, int h) {
+        targetWidth = w;
+        targetHeight = h;
+        GLint filter = linearFilter ? GL_LINEAR : GL_NEAREST;
+        glGenTextures(1, &texture);
+        TextureRender::BindTexture(texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+        bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (!complete) {
+            release();
+            fboFailed = true;
+            scale = 1.0f;
+        }
+        return complete;
+    }
+};
+
+#endif // DYNAMIC_RESOLUTION_HPP
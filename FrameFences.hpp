@@ -0,0 +1,83 @@
+#ifndef FRAME_FENCES_HPP
+#define FRAME_FENCES_HPP
+
+#include <GL/glew.h>
+#include <chrono>
+#include <algorithm>
+
+// ---------- FRAME FENCES ----------
+// Limita i frame in coda al driver: dopo ogni swap si inserisce un fence e si aspetta
+// quello di maxFrames - 1 frame prima. Con 1 la CPU attende la fine del frame appena
+// inviato (latenza minima); valori più alti lasciano lavorare CPU e GPU in parallelo.
+// Serve GL 3.2 o ARB_sync; senza, il limite non si applica.
+struct FrameFences {
+    typedef std::chrono::steady_clock Clock;
+    static constexpr int MAX_FENCES = 8;
+
+    int maxFrames = 2; // frame in volo ammessi (0 = nessun limite)
+
+    // statistiche dell'attesa sui fence
+    unsigned long waits = 0;
+    double lastWait = 0.0, maxWait = 0.0, totalWait = 0.0;
+
+    explicit FrameFences(int framesInFlight)
+        : maxFrames(std::min(std::max(framesInFlight, 0), MAX_FENCES)) {}
+
+    bool supported() const {
+        return maxFrames > 0 && (GLEW_VERSION_3_2 || GLEW_ARB_sync);
+    }
+
+    // Da chiamare subito dopo glfwSwapBuffers
+    void frameSubmitted() {
+        if (!supported()) return;
+        fences[(first + count) % MAX_FENCES] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        count++;
+
+        Clock::time_point start = Clock::now();
+        while (count >= maxFrames && count > 0) {
+            GLsync oldest = fences[first];
+            // il primo giro svuota anche la coda dei comandi, poi si attende e basta
+            GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+            GLenum result;
+            do {
+                result = glClientWaitSync(oldest, flags, WAIT_SLICE_NS);
+                flags = 0;
+            } while (result == GL_TIMEOUT_EXPIRED);
+            glDeleteSync(oldest);
+            fences[first] = 0;
+            first = (first + 1) % MAX_FENCES;
+            count--;
+            if (result == GL_WAIT_FAILED) break;
+        }
+
+        lastWait = std::chrono::duration<double>(Clock::now() - start).count();
+        waits++;
+        totalWait += lastWait;
+        maxWait = std::max(maxWait, lastWait);
+    }
+
+    double averageWait() const {
+        return waits ? totalWait / waits : 0.0;
+    }
+
+    void resetStats() {
+        waits = 0;
+        lastWait = maxWait = totalWait = 0.0;
+    }
+
+    void release() {
+        while (count > 0) {
+            glDeleteSync(fences[first]);
+            fences[first] = 0;
+            first = (first + 1) % MAX_FENCES;
+            count--;
+        }
+    }
+
+private:
+    static constexpr GLuint64 WAIT_SLICE_NS = 100000000; // 100 ms per tentativo
+    GLsync fences[MAX_FENCES] = {};
+    int first = 0, count = 0;
+};
+
+#endif // FRAME_FENCES_HPP
@@ -0,0 +1,81 @@
+#ifndef FRAME_SCHEDULER_HPP
+#define FRAME_SCHEDULER_HPP
+
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+// ---------- FRAME SCHEDULER ----------
+// Limita il loop a una frequenza di rendering: sleep "grossolano" fino a poco prima
+// della scadenza, poi spin breve per arrivarci con precisione (lo sleep del sistema
+// operativo può sforare di qualche millisecondo). Tiene le statistiche di quanto
+// ogni frame ha mancato la sua scadenza.
+struct FrameScheduler {
+    typedef std::chrono::steady_clock Clock;
+
+    double period = 0.0;        // secondi per frame (0 = illimitato)
+    double spinMargin = 0.002;  // ultimi secondi prima della scadenza fatti in spin
+    double lateTolerance = 0.0001; // uscita dallo spin entro questa soglia: puntuale
+    Clock::time_point deadline = Clock::now();
+
+    // statistiche (ritardo = quanto il frame era già oltre la scadenza)
+    unsigned long frames = 0, lateFrames = 0;
+    double lastMiss = 0.0, maxMiss = 0.0, totalMiss = 0.0;
+
+    FrameScheduler(double targetFps, double spin) : spinMargin(spin) {
+        setTargetFps(targetFps);
+    }
+
+    void setTargetFps(double targetFps) {
+        period = targetFps > 0.0 ? 1.0 / targetFps : 0.0;
+        deadline = Clock::now();
+    }
+
+    // Da chiamare una volta per frame, dopo lo swap
+    void waitForNextFrame() {
+        if (period <= 0.0) return;
+
+        const auto periodDuration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(period));
+        deadline += periodDuration;
+
+        Clock::time_point now = Clock::now();
+        double miss = std::chrono::duration<double>(now - deadline).count();
+        if (miss <= 0.0) {
+            // sleep fino a spinMargin prima della scadenza...
+            auto spinStart = deadline - std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(spinMargin));
+            if (now < spinStart) std::this_thread::sleep_until(spinStart);
+            // ...poi spin fino alla scadenza
+            while (Clock::now() < deadline) std::this_thread::yield();
+            // anche l'attesa può sforare (sleep oltre spinMargin, thread deschedulato)
+            now = Clock::now();
+            miss = std::chrono::duration<double>(now - deadline).count();
+            if (miss < lateTolerance) miss = 0.0; // fine normale dello spin
+        }
+
+        frames++;
+        lastMiss = std::max(0.0, miss);
+        if (miss > 0.0) {
+            lateFrames++;
+            totalMiss += miss;
+            maxMiss = std::max(maxMiss, miss);
+            // più di un frame di ritardo: si riparte da adesso invece di recuperare a raffica
+            if (miss > period) deadline = now;
+        }
+    }
+
+    // Dopo un'attesa fuori dallo scheduler (frame inattivi): si riparte da adesso
+    void resync() {
+        deadline = Clock::now();
+    }
+
+    double averageMiss() const {
+        return lateFrames ? totalMiss / lateFrames : 0.0;
+    }
+
+    void resetStats() {
+        frames = lateFrames = 0;
+        lastMiss = maxMiss = totalMiss = 0.0;
+    }
+};
+
+#endif // FRAME_SCHEDULER_HPP
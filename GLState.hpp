@@ -0,0 +1,82 @@
+#ifndef GL_STATE_HPP
+#define GL_STATE_HPP
+
+#include <GL/glew.h>
+
+// ---------- GL STATE CACHE ----------
+// Tiene traccia di texture legata (unità 0), GL_BLEND, GL_TEXTURE_2D e blend func:
+// le chiamate che non cambiano nulla vengono saltate e contate.
+// Chi modifica lo stato senza passare di qui deve chiamare InvalidateState().
+namespace TextureRender {
+
+    struct GLStateStats {
+        unsigned long issued = 0;   // chiamate GL effettivamente eseguite
+        unsigned long skipped = 0;  // chiamate ridondanti evitate
+    };
+
+    struct GLStateCache {
+        GLuint texture = 0;
+        bool textureKnown = false;
+        int blend = -1, texture2D = -1;  // -1 = sconosciuto, 0 = off, 1 = on
+        GLenum blendSrc = 0, blendDst = 0;
+        bool blendFuncKnown = false;
+    };
+
+    static GLStateStats stateStats;
+    static GLStateCache glState;
+
+    inline void InvalidateState() {
+        glState = GLStateCache();
+    }
+
+    inline void BindTexture(GLuint texture) {
+        if (glState.textureKnown && glState.texture == texture) {
+            stateStats.skipped++;
+            return;
+        }
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glState.texture = texture;
+        glState.textureKnown = true;
+        stateStats.issued++;
+    }
+
+    // Da usare al posto di glDeleteTextures: GL torna alla texture 0 se quella legata viene cancellata
+    inline void DeleteTextures(GLsizei n, const GLuint* textures) {
+        for (GLsizei i = 0; i < n; i++) {
+            if (glState.textureKnown && glState.texture == textures[i]) glState.texture = 0;
+        }
+        glDeleteTextures(n, textures);
+    }
+
+    inline void SetEnabled(GLenum cap, bool enabled) {
+        int* tracked = (cap == GL_BLEND) ? &glState.blend
+                     : (cap == GL_TEXTURE_2D) ? &glState.texture2D
+                     : nullptr;
+        if (tracked && *tracked == int(enabled)) {
+            stateStats.skipped++;
+            return;
+        }
+        if (enabled) glEnable(cap);
+        else glDisable(cap);
+        if (tracked) *tracked = int(enabled);
+        stateStats.issued++;
+    }
+
+    inline void Enable(GLenum cap)  { SetEnabled(cap, true); }
+    inline void Disable(GLenum cap) { SetEnabled(cap, false); }
+
+    inline void BlendFunc(GLenum src, GLenum dst) {
+        if (glState.blendFuncKnown && glState.blendSrc == src && glState.blendDst == dst) {
+            stateStats.skipped++;
+            return;
+        }
+        glBlendFunc(src, dst);
+        glState.blendSrc = src;
+        glState.blendDst = dst;
+        glState.blendFuncKnown = true;
+        stateStats.issued++;
+    }
+
+} // namespace TextureRender
+
+#endif // GL_STATE_HPP
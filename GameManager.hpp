@@ -8,9 +8,22 @@
 #include <sstream>
 #include "Variable.hpp"
 #include "TextureLoader.hpp"  // mantiene TextureRender::RenderTexture
+#include "TileLayer.hpp"
+#include "TilemapLayer.hpp"
+#include "BackgroundCache.hpp"
+#include "DrawList.hpp"
+#include "SpriteRenderer.hpp"
+#include "Transition.hpp"
+#include "SubsystemScheduler.hpp"
+#include "ThreadPool.hpp"
+#include "LevelFormat.hpp"
+#include "AssetPack.hpp"
 #include <algorithm>
-#include <functional>
 #include <filesystem>
+#include <cstdint>
+#include <cmath>
+#include <memory>
+#include <mutex>
 
 // ---------- COSTANTI MONDO ----------
 const float WORLD_X_MIN = 0.0f;
@@ -21,6 +34,7 @@ const float WORLD_Y_MAX = 45.3f;
 // ---------- DECORATION ----------
 struct Decoration {
     std::string texturePath;
+    TextureRender::TextureHandle texture = TextureRender::INVALID_TEXTURE; // risolto al caricamento
     float x, y;         // coordinate nella griglia
     float width, height; // dimensioni in tiles
     float render_height_y=0; //serve per il rendering
@@ -30,10 +44,12 @@ struct Portal : public Decoration {
     std::string path_new_level;
     int new_player_x_cord, new_player_y_cord;
     float render_height_x=0; //serve per i portali per la logica di teletrasporto
+    int targetLevel = -1; // id della destinazione risolto da levelc (-1 = si cerca in LevelMap)
 };
 // ---------- ENTITY ----------
 struct Entity {
     std::string texturePath;
+    TextureRender::TextureHandle texture = TextureRender::INVALID_TEXTURE; // risolto al caricamento
     int x, y;         // coordinate nella griglia (in tiles)
     float width, height; // dimensioni base in tiles
     float scaleX = 1.0f, scaleY = 1.0f; // scala dimensionale
@@ -47,15 +63,19 @@ struct Entity {
 
     float render_height_y=0; //serve per il rendering
 
-    void updateAnimation(float dt) {
+    // true se il frame è cambiato
+    bool updateAnimation(float dt) {
         animTimer += dt;
         if(animTimer >= animDelay) {
             animTimer -= animDelay;
+            int previous = currentFrameX;
             currentFrameX = (currentFrameX + 1) % (stop_frame_y);
+            return currentFrameX != previous;
         }
+        return false;
     }
-    void renderEntity(float quadSizeX, float quadSizeY) const {
-        int frameX = currentFrameX, frameY = currentFrameY;
+    // Aggiunge un frame alla draw list (il frame arriva dallo snapshot, non dallo stato mutabile)
+    void pushDraw(DrawList& list, float quadSizeX, float quadSizeY, int frameX, int frameY) const {
 
         // Dimensioni finali del quad (scala applicata)
         float finalWidth  = quadSizeX * width  * scaleX;   // larghezza in tiles moltiplicata per la scala
@@ -65,27 +85,10 @@ struct Entity {
         float centerX = -1.0f + x * quadSizeX + quadSizeX * 0.5f;
         float centerY = -1.0f + y * quadSizeY + quadSizeY * 0.5f;
 
-        // Coordinate finali del quad (centro in centerX/centerY)
-        float x0 = centerX - finalWidth  / 2.0f;
-        float y0 = centerY - finalHeight / 2.0f;
-        float x1 = centerX + finalWidth  / 2.0f;
-        float y1 = centerY + finalHeight / 2.0f;
-
-        // Coordinate texture
-        float tx0 = frameX / float(framesPerRow);
-        float ty0 = frameY / float(framesPerCol);
-        float tx1 = (frameX + 1) / float(framesPerRow);
-        float ty1 = (frameY + 1) / float(framesPerCol);
-
-        GLuint texID = TextureRender::LoadTextureFromFile(texturePath);
-        glBindTexture(GL_TEXTURE_2D, texID);
-
-        glBegin(GL_QUADS);
-            glTexCoord2f(tx0, ty1); glVertex2f(x0, y0);
-            glTexCoord2f(tx1, ty1); glVertex2f(x1, y0);
-            glTexCoord2f(tx1, ty0); glVertex2f(x1, y1);
-            glTexCoord2f(tx0, ty0); glVertex2f(x0, y1);
-        glEnd();
+        list.push(render_height_y, texture,
+                  centerX - finalWidth  / 2.0f, centerY - finalHeight / 2.0f,
+                  centerX + finalWidth  / 2.0f, centerY + finalHeight / 2.0f,
+                  frameX, frameY, framesPerRow, framesPerCol);
     }
 
 };
@@ -97,6 +100,7 @@ struct Hitbox {
 struct Tile {
     int id = 0;
     std::string texturePath; // path diretta alla texture
+    TextureRender::TextureHandle texture = TextureRender::INVALID_TEXTURE;
 };
 //mappa per memorizzare il percorso dei livelli
 static std::map<std::string, int> LevelMap;
@@ -108,6 +112,15 @@ struct Level {
     std::vector<Portal> portals;
     std::vector<Entity> entity;
     std::vector<Hitbox> hitboxes;
+    TileLayer tileLayer; // background precalcolato (costruito sul thread GL al primo rendering)
+    TilemapLayer tilemap; // alternativa con shader, usata se pronta
+    bool glReady = false; // texture registrate e background costruito (solo thread GL)
+    std::vector<TextureRender::TextureHandle> textureRefs; // texture trattenute dal livello (thread GL)
+
+    void drawBackground() const {
+        if (tilemap.ready()) tilemap.draw();
+        else tileLayer.draw();
+    }
 
     Level(int w, int h) : width(w), height(h), tiles(w*h) {}
 
@@ -115,14 +128,26 @@ struct Level {
     const Tile& getTile(int x, int y) const { return tiles[y*width + x]; }
 };
 // ---------- FUNZIONE DI CARICAMENTO ----------
-inline Level loadLevelFromFile(const std::string& filename, int w, int h) {
-    std::cout << "CARICO LIVELLO: " << filename << std::endl;
-    Level lvl(w, h);
-    std::ifstream file(filename);
-    if (!file) { 
-        std::cerr << "Errore: impossibile aprire " << filename << std::endl; 
-        exit(1); 
+// Parsing e hitbox di un livello (dal pacchetto asset o dal file). Non tocca stato
+// globale (texture, LevelMap): si può eseguire su più thread insieme; i messaggi
+// finiscono in log e vengono stampati da chi unisce i risultati, nell'ordine dei livelli.
+// Ogni modifica al risultato va segnata in LevelFormat::PARSER_REVISION (i .lvlb vecchi
+// vengono scartati).
+inline bool parseLevelFile(const std::string& filename, Level& lvl, std::ostream& log) {
+    log << "CARICO LIVELLO: " << filename << std::endl;
+    const int w = lvl.width;
+    AssetPack::Asset asset;
+    std::istringstream packed;
+    std::ifstream loose;
+    std::istream* input = &packed;
+    if (AssetPack::Read(filename, asset)) {
+        packed.str(std::string(reinterpret_cast<const char*>(asset.data), asset.size));
+    } else {
+        loose.open(filename);
+        if (!loose) return false;
+        input = &loose;
     }
+    std::istream& file = *input;
 
     // calcolo dimensione di ogni tile nello spazio del mondo
     float TILE_SIZE_X = (WORLD_X_MAX - WORLD_X_MIN) / GRID_SIZE;
@@ -152,7 +177,7 @@ inline Level loadLevelFromFile(const std::string& filename, int w, int h) {
             lvl.decorations.push_back(dec);
             lvl.hitboxes.push_back(hb);
 
-            std::cout << "Decorazione trovata: " << dec.texturePath
+            log << "Decorazione trovata: " << dec.texturePath
                       << " -> hitbox float: x0=" << hb.x0
                       << " y0=" << hb.y0
                       << " x1=" << hb.x1
@@ -178,7 +203,7 @@ inline Level loadLevelFromFile(const std::string& filename, int w, int h) {
             lvl.portals.push_back(port);
             lvl.hitboxes.push_back(hb);
 
-            std::cout << "Portale trovata: " << port.texturePath
+            log << "Portale trovata: " << port.texturePath
                       << " -> hitbox float: x0=" << hb.x0
                       << " y0=" << hb.y0
                       << " x1=" << hb.x1
@@ -215,7 +240,7 @@ inline Level loadLevelFromFile(const std::string& filename, int w, int h) {
             lvl.entity.push_back(ent);
             lvl.hitboxes.push_back(hb);
 
-            std::cout << "Entita trovata: " << ent.texturePath
+            log << "Entita trovata: " << ent.texturePath
                       << " -> hitbox float: x0=" << hb.x0
                       << " y0=" << hb.y0
                       << " x1=" << hb.x1
@@ -242,14 +267,217 @@ inline Level loadLevelFromFile(const std::string& filename, int w, int h) {
 
     }
 
-    return lvl;
+    return true;
+}
+
+// ---------- LIVELLI COMPILATI ----------
+inline std::string compiledLevelPath(const std::string& filename) {
+    return std::filesystem::path(filename).replace_extension(".lvlb").string();
+}
+
+// Livello da un .lvlb (LevelFormat.hpp) già in memoria (file mappato o voce del
+// pacchetto): i dati vengono validati e i record copiati nel livello; hitbox e altezze
+// di rendering arrivano già calcolate. Come parseLevelFile non tocca stato globale.
+// Il livello resta intatto se il file è da scartare.
+inline bool loadCompiledLevel(const std::string& filename, const unsigned char* base, size_t size,
+                              Level& lvl, std::ostream& log) {
+    using namespace LevelFormat;
+    std::string error;
+    if (!Validate(base, size, error)) {
+        log << "Livello compilato scartato (" << filename << "): " << error << std::endl;
+        return false;
+    }
+    Header h;
+    std::memcpy(&h, base, sizeof(h));
+    if (h.width != lvl.width || h.height != lvl.height || h.gridSize != GRID_SIZE) {
+        log << "Livello compilato scartato (" << filename << "): griglia diversa, ricompilare con levelc" << std::endl;
+        return false;
+    }
+    if (h.parserRevision != PARSER_REVISION) {
+        log << "Livello compilato scartato (" << filename << "): parser cambiato, ricompilare con levelc" << std::endl;
+        return false;
+    }
+
+    const char* strings = reinterpret_cast<const char*>(base + h.strings.offset);
+    const uint32_t* textureTable = reinterpret_cast<const uint32_t*>(base + h.textures.offset);
+    const TileRecord* tiles = reinterpret_cast<const TileRecord*>(base + h.tiles.offset);
+    const DecorationRecord* decorations = reinterpret_cast<const DecorationRecord*>(base + h.decorations.offset);
+    const PortalRecord* portals = reinterpret_cast<const PortalRecord*>(base + h.portals.offset);
+    const EntityRecord* entities = reinterpret_cast<const EntityRecord*>(base + h.entities.offset);
+
+    // indici controllati prima di scrivere nel livello
+    auto badTexture = [&h](uint32_t t) { return t >= h.textures.count; };
+    bool ok = true;
+    for (uint32_t i = 0; i < h.tiles.count; i++) ok &= tiles[i].texture == NONE || !badTexture(tiles[i].texture);
+    for (uint32_t i = 0; i < h.decorations.count; i++) ok &= !badTexture(decorations[i].texture);
+    for (uint32_t i = 0; i < h.portals.count; i++)
+        ok &= !badTexture(portals[i].base.texture) && portals[i].targetPath < h.strings.count;
+    for (uint32_t i = 0; i < h.entities.count; i++) ok &= !badTexture(entities[i].texture);
+    if (!ok) {
+        log << "Livello compilato scartato (" << filename << "): indice fuori tabella" << std::endl;
+        return false;
+    }
+
+    log << "CARICO LIVELLO COMPILATO: " << filename << std::endl;
+    std::vector<std::string> textures(h.textures.count);
+    for (uint32_t i = 0; i < h.textures.count; i++) textures[i] = strings + textureTable[i];
+
+    for (uint32_t i = 0; i < h.tiles.count; i++) {
+        lvl.tiles[i].id = tiles[i].id;
+        if (tiles[i].texture != NONE) lvl.tiles[i].texturePath = textures[tiles[i].texture];
+    }
+
+    auto fillDecoration = [&textures](const DecorationRecord& r, Decoration& dec) {
+        dec.texturePath = textures[r.texture];
+        dec.x = r.x;
+        dec.y = r.y;
+        dec.width = r.width;
+        dec.height = r.height;
+        dec.render_height_y = r.renderHeightY;
+    };
+    lvl.decorations.resize(h.decorations.count);
+    for (uint32_t i = 0; i < h.decorations.count; i++) fillDecoration(decorations[i], lvl.decorations[i]);
+
+    lvl.portals.resize(h.portals.count);
+    for (uint32_t i = 0; i < h.portals.count; i++) {
+        const PortalRecord& r = portals[i];
+        Portal& port = lvl.portals[i];
+        fillDecoration(r.base, port);
+        port.path_new_level = strings + r.targetPath;
+        port.targetLevel = r.targetLevel == NONE ? -1 : int(r.targetLevel);
+        port.new_player_x_cord = r.newPlayerX;
+        port.new_player_y_cord = r.newPlayerY;
+        port.render_height_x = r.renderHeightX;
+    }
+
+    lvl.entity.resize(h.entities.count);
+    for (uint32_t i = 0; i < h.entities.count; i++) {
+        const EntityRecord& r = entities[i];
+        Entity& ent = lvl.entity[i];
+        ent.texturePath = textures[r.texture];
+        ent.x = r.x;
+        ent.y = r.y;
+        ent.width = r.width;
+        ent.height = r.height;
+        ent.scaleX = r.scaleX;
+        ent.scaleY = r.scaleY;
+        ent.frameWidth = r.frameWidth;
+        ent.frameHeight = r.frameHeight;
+        ent.framesPerRow = r.framesPerRow;
+        ent.framesPerCol = r.framesPerCol;
+        ent.currentFrameX = r.currentFrameX;
+        ent.stop_frame_y = r.stopFrameY;
+        ent.render_height_y = r.renderHeightY;
+    }
+
+    // stesso layout: copia diretta
+    static_assert(sizeof(Hitbox) == sizeof(HitboxRecord), "Hitbox e HitboxRecord devono coincidere");
+    lvl.hitboxes.resize(h.hitboxes.count);
+    if (h.hitboxes.count) std::memcpy(lvl.hitboxes.data(), base + h.hitboxes.offset, h.hitboxes.count * sizeof(Hitbox));
+    return true;
+}
+
+inline bool loadCompiledLevel(const std::string& filename, Level& lvl, std::ostream& log) {
+    MappedFile file;
+    if (!file.open(filename)) return false;
+    return loadCompiledLevel(filename, file.data(), file.size(), lvl, log);
+}
+
+// Ordine di ricerca: .lvlb nel pacchetto asset (se il .txt sciolto non è più recente del
+// pacchetto), poi .lvlb sciolto se non è più vecchio del .txt (si può modificare il testo
+// senza ricompilare), infine parsing del testo (pacchetto o file). Basta anche il solo .lvlb.
+inline bool readLevel(const std::string& filename, Level& lvl, std::ostream& log) {
+    if (COMPILED_LEVELS) {
+        namespace fs = std::filesystem;
+        const std::string compiled = compiledLevelPath(filename);
+        AssetPack::Asset asset;
+        if (!AssetPack::LooseIsNewer(filename) && AssetPack::Read(compiled, asset)) {
+            if (loadCompiledLevel(compiled, asset.data, asset.size, lvl, log)) return true;
+        } else {
+            std::error_code binError, textError;
+            fs::file_time_type binTime = fs::last_write_time(compiled, binError);
+            fs::file_time_type textTime = fs::last_write_time(filename, textError);
+            if (!binError && (textError || textTime <= binTime)) {
+                if (loadCompiledLevel(compiled, lvl, log)) return true;
+            } else if (!binError) {
+                log << "Livello compilato piu' vecchio di " << filename << ": uso il testo" << std::endl;
+            }
+        }
+    }
+    return parseLevelFile(filename, lvl, log);
+}
+
+// Path dei livelli di una cartella in ordine (l'indice è l'id del livello), unendo i
+// file sciolti e quelli del pacchetto asset. Un .lvlb senza il .txt corrispondente conta
+// come il .txt, così le build distribuite possono contenere solo i livelli compilati.
+inline std::vector<std::string> listLevelPaths(const std::string& folder) {
+    namespace fs = std::filesystem;
+    std::vector<std::string> paths;
+    auto addLevel = [&paths](fs::path path) {
+        if (path.extension() == ".lvlb") path.replace_extension(".txt");
+        else if (path.extension() != ".txt") return;
+        paths.push_back(path.string());
+    };
+    for (const std::string& name : AssetPack::List(folder)) {
+        addLevel(fs::path(folder) / fs::path(name).filename()); // stesso formato del directory_iterator
+    }
+    std::error_code missing;
+    if (!AssetPack::IsOpen() || fs::is_directory(folder, missing)) { // col pacchetto la cartella è facoltativa
+        try {
+            for (const auto& entry : fs::directory_iterator(folder)) {
+                if (entry.is_regular_file()) addLevel(entry.path());
+            }
+        } catch (const fs::filesystem_error& e) {
+            std::cerr << "Errore nell'accesso alla cartella " << folder 
+                      << ": " << e.what() << std::endl;
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+    paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+    return paths;
+}
+
+// Handle e footprint delle texture del livello (thread GL: modifica le tabelle globali e
+// può ricaricare le texture già residenti che il livello disegna più grandi)
+inline void registerLevelTextures(Level& lvl) {
+    for (Decoration& dec : lvl.decorations) {
+        dec.texture = TextureRender::RegisterTexture(dec.texturePath);
+        TextureRender::GrowFootprint(dec.texturePath, dec.width, dec.height);
+    }
+    for (Portal& port : lvl.portals) {
+        port.texture = TextureRender::RegisterTexture(port.texturePath);
+        TextureRender::GrowFootprint(port.texturePath, port.width, port.height);
+    }
+    for (Entity& ent : lvl.entity) ent.texture = TextureRender::RegisterTexture(ent.texturePath);
+    for (Tile& tile : lvl.tiles) {
+        // riga mancante nel .txt (o record NONE del .lvlb): texture di default, come per gli id sconosciuti
+        if (tile.texturePath.empty()) tile.texturePath = "texture/block/null.png";
+        tile.texture = TextureRender::RegisterTexture(tile.texturePath);
+        TextureRender::GrowFootprint(tile.texturePath, 1.0f, 1.0f);
+    }
+}
+
+// Stima della memoria occupata dal livello (dati di gioco e vertici del background).
+// Le texture si aggiungono dopo l'upload (GameManager::accountLevelTextures).
+inline size_t estimateLevelBytes(const Level& lvl) {
+    size_t bytes = sizeof(Level);
+    for (const Tile& tile : lvl.tiles) bytes += sizeof(Tile) + tile.texturePath.capacity();
+    for (const Decoration& dec : lvl.decorations) bytes += sizeof(Decoration) + dec.texturePath.capacity();
+    for (const Portal& port : lvl.portals)
+        bytes += sizeof(Portal) + port.texturePath.capacity() + port.path_new_level.capacity();
+    for (const Entity& ent : lvl.entity) bytes += sizeof(Entity) + ent.texturePath.capacity();
+    bytes += lvl.hitboxes.capacity() * sizeof(Hitbox);
+    bytes += lvl.tiles.size() * 4 * 4 * sizeof(float); // quad del TileLayer (pos + uv)
+    return bytes;
 }
+
 // ---------- PLAYER ----------
 struct Player {
     float x = 25.0f, y = 22.0f;
     int frameWidth = 10, frameHeight = 13;
     int framesPerRow = 8, framesPerCol = 8;
     std::string texturePath;
+    TextureRender::TextureHandle texture;
 
     float speed = 10.0f;
     int currentFrameX = 0, currentFrameY = 0;
@@ -258,7 +486,7 @@ struct Player {
     float playerWidth = 1.0f;  // dimensioni player in unità reali
     float playerHeight = 1.0f;
 
-    Player(const std::string& path) : texturePath(path) {}
+    Player(const std::string& path) : texturePath(path), texture(TextureRender::RegisterTexture(path)) {}
 
     bool collidesWithHitboxes(const Level& lvl, float newX, float newY) {
         for(auto& hb : lvl.hitboxes) {
@@ -307,185 +535,540 @@ struct Player {
         }
     }
 };
+// ---------- INPUT ----------
+struct PlayerInput {
+    bool up = false, down = false, left = false, right = false;
+
+    bool any() const { return up || down || left || right; }
+};
+// ---------- RENDER SNAPSHOT ----------
+// Stato immutabile pubblicato dalla logica per il rendering: il thread GL non legge
+// mai le parti mutabili di Player ed Entity. I vector mantengono la capacità tra
+// un frame e l'altro (gli slot del triple buffer vengono riutilizzati).
+struct RenderSnapshot {
+    int level = -1;
+    float prevPlayerX = 0.0f, prevPlayerY = 0.0f; // posizione al passo precedente (per l'interpolazione)
+    float playerX = 0.0f, playerY = 0.0f;
+    int playerFrameX = 0, playerFrameY = 0;
+    std::vector<uint16_t> entityFrames; // frameX, frameY per ogni entità del livello
+    float fadeAlpha = 0.0f;
+    uint64_t tick = 0;                  // passo di logica che l'ha prodotto
+    uint64_t visualVersion = 0;         // cambia solo quando cambia qualcosa di visibile
+    int idleTicks = -1;                 // passi prima del prossimo cambio senza nuovo input (-1 = nessuno)
+    uint64_t inputSerial = 0;           // eventi di input consumati dalla logica fino a questo snapshot
+    double inputTime = 0.0;             // evento più vecchio non ancora a schermo (0 = nessuno)
+    double publishTime = 0.0;           // istante (secondi, steady_clock) in cui è stato pubblicato
+};
 // ---------- GAME MANAGER ----------
 class GameManager {
     private:
-        std::vector<Level> levels;
-        void renderPlayer() {
-            renderPlayer(player.currentFrameX, player.currentFrameY);
+        // ---------- LIVELLI (caricati al primo accesso, scaricati in ordine LRU) ----------
+        struct LevelSlot {
+            std::string path;
+            int width, height;
+            std::shared_ptr<Level> level; // nullptr = non residente
+            uint64_t lastUse = 0;
+            size_t bytes = 0;             // stima, comprese le texture
+            size_t textureBytes = 0;      // parte di bytes: texture trattenute solo da questo livello
+        };
+        std::vector<LevelSlot> levels;            // fisso dopo la registrazione dei path
+        mutable std::mutex levelMutex;            // protegge level/lastUse degli slot e retiredLevels
+        std::vector<std::shared_ptr<Level>> retiredLevels; // scaricati, in attesa del thread GL
+        uint64_t levelClock = 0;
+        size_t residentLevelBytes = 0;
+        unsigned long accountedGeneration = 0; // textureGeneration dell'ultimo conteggio delle texture
+        bool texturesChanged = false;          // livelli preparati o liberati dopo l'ultimo conteggio
+        BackgroundCache backgroundCache;
+        unsigned long cachedTextureGeneration = 0; // texture residenti quando la cache è stata disegnata
+        Transition transition{PORTAL_FADE_OUT, PORTAL_FADE_IN};
+        DrawList drawList; // riutilizzata a ogni frame
+        SpriteRenderer spriteRenderer;
+        float idleTime = 0.0f;             // secondi senza input
+        float prevPlayerX = 0.0f, prevPlayerY = 0.0f; // posizione prima dell'ultimo passo
+        const float idleThreshold = 0.5f;  // secondi di inattività prima del frame 0,0
+        uint64_t tickCount = 0;
+        uint64_t visualVersion = 0;        // incrementata dai passi che cambiano l'immagine
+        bool movedLastTick = false;        // l'ultimo frame disegnato era interpolato
+        float stepDt = 0.0f;               // durata dell'ultimo passo
+        SubsystemScheduler subsystems;     // movimento, animazioni, portali a frequenze proprie
+        PlayerInput moveInput;             // tasti premuti dall'ultimo tick di movimento
+        bool stepChanged = false;          // un sottosistema ha cambiato qualcosa di visibile
+
+        // ---------- SOTTOSISTEMI ----------
+        void tickMovement(float dt) {
+            const Level& lvl = getLevel(currentLevel);
+            if (moveInput.up)    player.moveUp(dt, lvl);
+            if (moveInput.down)  player.moveDown(dt, lvl);
+            if (moveInput.left)  player.moveLeft(dt, lvl);
+            if (moveInput.right) player.moveRight(dt, lvl);
+            idleTime = moveInput.any() ? 0.0f : idleTime + dt;
+            moveInput = PlayerInput(); // consumato: si riempie di nuovo dai passi successivi
         }
 
-        void renderPlayer(int frameX, int frameY) {
+        void tickAnimation(float dt) {
+            for (Entity& ent : getLevel(currentLevel).entity) stepChanged |= ent.updateAnimation(dt);
+        }
+
+        void tickPortals(float) {
+            if (!transition.active()) checkPortals(); // niente portali durante la dissolvenza
+        }
+
+        // Passi di durata stepDt necessari perché un timer avanzato dal sottosistema arrivi
+        // a deadline: il timer cresce solo ai tick del sottosistema, quindi si contano i suoi
+        // tick (rifacendo le stesse somme in float del timer) e la fase del suo accumulatore
+        int ticksUntil(const char* subsystem, float timer, float deadline) const {
+            const float period = float(subsystems.periodOf(subsystem));
+            if (stepDt <= 0.0f || period <= 0.0f) return 1;
+            unsigned ticks = 1;
+            for (float t = timer + period; t < deadline; t += period) ticks++;
+            double seconds = subsystems.timeUntilTick(subsystem, ticks);
+            return std::max(1, int(std::ceil(seconds / stepDt - 1e-6)));
+        }
+
+        void pushPlayer(const RenderSnapshot& snap, float alpha) {
+            // posizione interpolata tra gli ultimi due passi di logica
+            float px = snap.prevPlayerX + (snap.playerX - snap.prevPlayerX) * alpha;
+            float py = snap.prevPlayerY + (snap.playerY - snap.prevPlayerY) * alpha;
+
             float scale = 0.037f;
-            float x0 = -1.13f + player.x * scale;
-            float y0 = -1.05f + player.y * scale;
+            float x0 = -1.13f + px * scale;
+            float y0 = -1.05f + py * scale;
             float x1 = x0 + player.frameWidth * scale;
             float y1 = y0 + player.frameHeight * scale;
 
-            float tx0 = frameX / float(player.framesPerRow);
-            float ty0 = frameY / float(player.framesPerCol);
-            float tx1 = (frameX + 1) / float(player.framesPerRow);
-            float ty1 = (frameY + 1) / float(player.framesPerCol);
+            drawList.push(py, player.texture, x0, y0, x1, y1,
+                          snap.playerFrameX, snap.playerFrameY, player.framesPerRow, player.framesPerCol);
+        }
+
+        void pushDecoration(const Decoration& dec, float quadSizeX, float quadSizeY) {
+            float x0 = -1.0f + dec.x * quadSizeX;
+            float y0 = -1.0f + dec.y * quadSizeY;
+            drawList.push(dec.render_height_y, dec.texture, x0, y0,
+                          x0 + dec.width * quadSizeX, y0 + dec.height * quadSizeY);
+        }
+
+        // Decorazioni e portali del livello in ordine di Y (usato per la cache del background)
+        void renderStaticDecorations(const Level& lvl) {
+            float quadSizeX = 2.0f / lvl.width;
+            float quadSizeY = 2.0f / lvl.height;
+            drawList.clear();
+            for (const auto& dec : lvl.decorations) pushDecoration(dec, quadSizeX, quadSizeY);
+            for (const auto& port : lvl.portals) pushDecoration(port, quadSizeX, quadSizeY);
+            drawList.sort();
+            drawList.submit();
+        }
+
+        // Scarica i livelli usati meno di recente finché si sta sotto LEVEL_MEMORY_CAP.
+        // Non tocca il livello corrente né la destinazione di un portale. Il livello
+        // scaricato passa al thread GL (collectRetiredLevels) per liberare le risorse GL.
+        // Chiamata con levelMutex acquisito.
+        void evictLevels(int keep) {
+            while (residentLevelBytes > LEVEL_MEMORY_CAP) {
+                int victim = -1;
+                for (int i = 0; i < (int)levels.size(); i++) {
+                    if (!levels[i].level || i == keep || i == currentLevel) continue;
+                    if (transition.active() && i == transition.targetLevel) continue;
+                    if (victim < 0 || levels[i].lastUse < levels[victim].lastUse) victim = i;
+                }
+                if (victim < 0) return; // solo livelli in uso: si sfora il limite
+                LevelSlot& slot = levels[victim];
+                std::cout << "Scarico livello: " << slot.path << std::endl;
+                retiredLevels.push_back(std::move(slot.level));
+                slot.level.reset();
+                residentLevelBytes -= slot.bytes;
+                slot.bytes = 0;
+                slot.textureBytes = 0;
+            }
+        }
+
+        // Texture e background del livello: solo sul thread GL, al primo rendering
+        void prepareLevelGL(Level& lvl) {
+            registerLevelTextures(lvl);
+            for (const Tile& tile : lvl.tiles) lvl.textureRefs.push_back(tile.texture);
+            for (const Decoration& dec : lvl.decorations) lvl.textureRefs.push_back(dec.texture);
+            for (const Portal& port : lvl.portals) lvl.textureRefs.push_back(port.texture);
+            for (const Entity& ent : lvl.entity) lvl.textureRefs.push_back(ent.texture);
+            std::sort(lvl.textureRefs.begin(), lvl.textureRefs.end());
+            lvl.textureRefs.erase(std::unique(lvl.textureRefs.begin(), lvl.textureRefs.end()), lvl.textureRefs.end());
+            for (TextureRender::TextureHandle handle : lvl.textureRefs) TextureRender::RetainTexture(handle);
+            buildTileLayer(lvl);
+            lvl.glReady = true;
+            texturesChanged = true;
+        }
+
+        // Thread GL: aggiunge alla stima di ogni livello le texture GL che solo lui trattiene
+        // (la dimensione si conosce solo dopo l'upload). Le texture condivise tra più livelli
+        // non si contano: scaricarne uno non le libererebbe. Se si sfora LEVEL_MEMORY_CAP si
+        // scarica al prossimo acquireLevel della logica.
+        void accountLevelTextures() {
+            if (!texturesChanged && accountedGeneration == TextureRender::textureGeneration) return;
+            texturesChanged = false;
+            accountedGeneration = TextureRender::textureGeneration;
+            std::lock_guard<std::mutex> lock(levelMutex);
+            for (LevelSlot& slot : levels) {
+                if (!slot.level || !slot.level->glReady) continue;
+                size_t bytes = 0;
+                for (TextureRender::TextureHandle handle : slot.level->textureRefs) {
+                    if (TextureRender::TextureRefCount(handle) == 1) bytes += TextureRender::TextureBytes(handle);
+                }
+                residentLevelBytes = residentLevelBytes - slot.textureBytes + bytes;
+                slot.bytes = slot.bytes - slot.textureBytes + bytes;
+                slot.textureBytes = bytes;
+            }
+        }
+
+        // Id del livello di destinazione: quello risolto da levelc se corrisponde ancora
+        // allo stesso path (cartella cambiata dopo la compilazione), altrimenti LevelMap
+        int portalTarget(const Portal& port) const {
+            if (port.targetLevel >= 0 && port.targetLevel < (int)levels.size() &&
+                levels[port.targetLevel].path == port.path_new_level) return port.targetLevel;
+            auto it = LevelMap.find(port.path_new_level);
+            return it != LevelMap.end() ? it->second : -1;
+        }
+
+        // controlliamo se il player interagisce con un portale
+        void checkPortals() {
+            for (const auto& port : getLevel(currentLevel).portals) {
+                #define MARGIN_PORTAL_X 0.12f
+                #define MARGIN_PORTAL_Y 0.3f
+                //se la x,y del player sono vicine alla x,y del portale allora 
+                //carica il nuovo livello
+                if (port.render_height_x * (1.0f - MARGIN_PORTAL_X) <= player.x && port.render_height_x * (1.0f + MARGIN_PORTAL_X) >= player.x){
+                    //se il player e' nel margine del portale
+                    if (port.render_height_y * (1.0f - ((port.height <=2) ? MARGIN_PORTAL_Y : 0.05f)) <= player.y && port.render_height_y * (1.0f) >= player.y){
+                        //se il player e' nel margine anche delle y del portale
+                        printf("INTERAZIONE PORTALE!!!!! \n");
+                        int target = portalTarget(port);
+                        if (target >= 0) {
+                            std::cout << "Cambio scena, nuovo livello = " << levels[target].path << std::endl;
+                            std::cout << "SPOSTO PLAYER A: x= " << port.new_player_x_cord << "; y= " << port.new_player_y_cord << std::endl;
+                            transition.start(target, port.new_player_x_cord, port.new_player_y_cord);
+                            acquireLevel(target); // caricato durante la dissolvenza in uscita
+                            break;
+                        } else {
+                            std::cerr << "ERRORE GRAVE: livello non trovato nella HashMap! (" << port.path_new_level << ")" << std::endl;
+                        }
 
-            GLuint texID = TextureRender::LoadTextureFromFile(player.texturePath);
-            glBindTexture(GL_TEXTURE_2D, texID);
+                    }
 
-            glBegin(GL_QUADS);
-                glTexCoord2f(tx0, ty1); glVertex2f(x0, y0);
-                glTexCoord2f(tx1, ty1); glVertex2f(x1, y0);
-                glTexCoord2f(tx1, ty0); glVertex2f(x1, y1);
-                glTexCoord2f(tx0, ty0); glVertex2f(x0, y1);
-            glEnd();
+                }
+            }
         }
     public:
         Player player{"texture/char_a_p1/char_a_p1_0bas_humn_v01.png"};
+        int currentLevel = -1; // scritto solo dalla logica
+
+        // Ordine di esecuzione: movimento, animazioni, portali (nuovi sottosistemi, es. AI, in coda)
+        GameManager() {
+            subsystems.add("movement", MOVEMENT_HZ, [this](float dt) { tickMovement(dt); });
+            subsystems.add("animation", ANIMATION_HZ, [this](float dt) { tickAnimation(dt); });
+            subsystems.add("portals", PORTAL_HZ, [this](float dt) { tickPortals(dt); });
+        }
+        GameManager(const GameManager&) = delete; // i sottosistemi tengono this
+        GameManager& operator=(const GameManager&) = delete;
+
+        // Registra il path con il prossimo id, senza leggerlo (thread principale, prima della logica)
+        int registerLevel(const std::string& filename, int w, int h) {
+            int id = int(levels.size());
+            LevelMap.insert({filename, id}); //inserisce nella HashMap l'indice del arrau della posizione del livello 
+            levels.push_back(LevelSlot{filename, w, h, nullptr, 0, 0});
+            return id;
+        }
 
         void addLevel(const std::string& filename, int w, int h) {
-            LevelMap.insert({filename, levels.size()}); //inserisce nella HashMap l'indice del arrau della posizione del livello 
-            levels.push_back(loadLevelFromFile(filename, w, h)); //inseriamo nel array il livello (sara nel indice trovato prima)
+            acquireLevel(registerLevel(filename, w, h));
         }
 
-        Level& getLevel(int idx) {
-            return levels[idx];
+        // Livello già letto (es. da un worker): lo aggiunge con il prossimo id
+        void addLevel(const std::string& filename, Level&& lvl) {
+            int id = registerLevel(filename, lvl.width, lvl.height);
+            std::lock_guard<std::mutex> lock(levelMutex);
+            LevelSlot& slot = levels[id];
+            slot.bytes = estimateLevelBytes(lvl);
+            slot.level = std::make_shared<Level>(std::move(lvl));
+            slot.lastUse = ++levelClock;
+            residentLevelBytes += slot.bytes;
+            evictLevels(id);
         }
 
-        void renderLevel(int& lvl_number, double frameTime, bool playerActive) {
-            if (lvl_number < 0 || lvl_number >= (int)levels.size()) {
-                std::cerr << "Errore: livello " << lvl_number << " inesistente!\n";
-                return;
+        int levelCount() const { return int(levels.size()); }
+
+        // Livello idx, letto dal file se non è residente (thread della logica o avvio).
+        // Il parsing avviene fuori dal lock; le texture e il VBO li prepara il thread GL.
+        std::shared_ptr<Level> acquireLevel(int idx) {
+            {
+                std::lock_guard<std::mutex> lock(levelMutex);
+                LevelSlot& slot = levels[idx];
+                slot.lastUse = ++levelClock;
+                if (slot.level) {
+                    if (residentLevelBytes > LEVEL_MEMORY_CAP) evictLevels(idx); // cresciuto con le texture
+                    return slot.level;
+                }
+            }
+            LevelSlot& slot = levels[idx];
+            Level lvl(slot.width, slot.height);
+            if (!readLevel(slot.path, lvl, std::cout)) {
+                std::cerr << "Errore: impossibile aprire " << slot.path << std::endl;
+                exit(1);
+            }
+            std::lock_guard<std::mutex> lock(levelMutex);
+            slot.bytes = estimateLevelBytes(lvl);
+            slot.level = std::make_shared<Level>(std::move(lvl));
+            residentLevelBytes += slot.bytes;
+            evictLevels(idx);
+            return slot.level;
+        }
+
+        // Thread GL: livello se residente (nessun caricamento), con le risorse GL pronte
+        std::shared_ptr<Level> peekLevel(int idx) {
+            std::shared_ptr<Level> lvl;
+            {
+                std::lock_guard<std::mutex> lock(levelMutex);
+                lvl = levels[idx].level;
+            }
+            if (lvl && !lvl->glReady) prepareLevelGL(*lvl);
+            return lvl;
+        }
+
+        // Thread GL: libera VBO, tilemap e texture dei livelli scaricati non più in uso
+        void collectRetiredLevels() {
+            std::vector<std::shared_ptr<Level>> done;
+            {
+                std::lock_guard<std::mutex> lock(levelMutex);
+                for (size_t i = 0; i < retiredLevels.size();) {
+                    if (retiredLevels[i].use_count() == 1) {
+                        done.push_back(std::move(retiredLevels[i]));
+                        retiredLevels.erase(retiredLevels.begin() + i);
+                    } else {
+                        i++;
+                    }
+                }
+            }
+            for (std::shared_ptr<Level>& lvl : done) {
+                if (!lvl->glReady) continue;
+                texturesChanged = true; // i riferimenti condivisi possono diventare unici
+                lvl->tileLayer.release();
+                lvl->tilemap.release();
+                for (TextureRender::TextureHandle handle : lvl->textureRefs) TextureRender::ReleaseTexture(handle);
+            }
+        }
+
+        // Prepara il VBO del background: serve il contesto GL attivo
+        void buildTileLayer(Level& lvl) {
+            // con lo shader basta la texture indice sul foglio condiviso
+            if (TilemapLayer::Supported()) {
+                std::vector<TextureRender::TextureHandle> handles;
+                handles.reserve(lvl.tiles.size());
+                for (const Tile& tile : lvl.tiles) handles.push_back(tile.texture);
+                if (lvl.tilemap.build(lvl.width, lvl.height, handles)) return;
             }
 
-            Level& lvl = levels[lvl_number];
             float quadSizeX = 2.0f / lvl.width;
             float quadSizeY = 2.0f / lvl.height;
-
-            // --- 1. Renderizza il background direttamente ---
             for (int y = 0; y < lvl.height; y++) {
                 for (int x = 0; x < lvl.width; x++) {
-                    Tile& tile = lvl.getTile(x, y);
-                    TextureRender::RenderTexture(tile.texturePath,
-                                                -1.0f + x * quadSizeX,
-                                                -1.0f + y * quadSizeY,
-                                                -1.0f + (x + 1) * quadSizeX,
-                                                -1.0f + (y + 1) * quadSizeY);
-                    
+                    const Tile& tile = lvl.getTile(x, y);
+                    const TextureAtlas::Region& r = TextureRender::ResolveTexture(tile.texture); // finisce nel VBO: niente segnaposto
+                    lvl.tileLayer.addQuad(r.texture, r.opaque,
+                                          -1.0f + x * quadSizeX,
+                                          -1.0f + y * quadSizeY,
+                                          -1.0f + (x + 1) * quadSizeX,
+                                          -1.0f + (y + 1) * quadSizeY,
+                                          r.u0, r.v0, r.u1, r.v1);
                 }
             }
+            lvl.tileLayer.build();
+        }
 
-            // --- 2. Metti tutto in un vector di Drawable ---
-            struct Drawable {
-                float y;                      // Y per ordinamento
-                std::function<void()> draw;    // funzione di rendering
-                std::string name;              // Player, Decorazione, Entità
-            };
+        // Thread della logica: il livello corrente e la destinazione di un portale non
+        // vengono mai scaricati, quindi il riferimento resta valido per tutto il passo
+        Level& getLevel(int idx) {
+            return *acquireLevel(idx);
+        }
 
-            std::vector<Drawable> drawables;
+        // ---------- LOGICA (passo fisso, thread della simulazione) ----------
+        // Passo base a HZ: ogni sottosistema esegue i tick maturati alla propria frequenza.
+        // I tasti premuti si accumulano fino al tick di movimento, così nessun tocco va perso.
+        void update(float dt, const PlayerInput& input) {
+            if (currentLevel < 0 || currentLevel >= (int)levels.size()) return;
+            getLevel(currentLevel); // carica il livello se serve (es. livello iniziale)
+            prevPlayerX = player.x;
+            prevPlayerY = player.y;
+            stepDt = dt;
+            const bool wasActive = idleTime < idleThreshold;
+            const bool wasFading = transition.active();
+
+            moveInput.up    |= input.up;
+            moveInput.down  |= input.down;
+            moveInput.left  |= input.left;
+            moveInput.right |= input.right;
+
+            stepChanged = false;
+            subsystems.advance(dt);
+
+            // transizione tra livelli (non bloccante, a ogni passo per una dissolvenza fluida)
+            if (transition.update(dt)) {
+                // schermo nero: cambio livello e posizione del player
+                currentLevel = transition.targetLevel;
+                player.x = prevPlayerX = transition.targetX; // teletrasporto: niente interpolazione
+                player.y = prevPlayerY = transition.targetY;
+                //TODO: sistemare animazioni dopo passaggio portale
+            }
 
-            // PLAYER
-            drawables.push_back(Drawable{
-                player.y, 
-                [this, playerActive]() {
-                    if (playerActive) renderPlayer();
-                    else renderPlayer(0, 0);
-                },
-                "Player"
-            });
+            // qualcosa di visibile è cambiato? (posizione, frame, dissolvenza, idle del player)
+            const bool moved = player.x != prevPlayerX || player.y != prevPlayerY;
+            bool changed = stepChanged || moved || movedLastTick || wasFading || transition.active();
+            changed |= (idleTime < idleThreshold) != wasActive;
+            movedLastTick = moved;
+            if (changed) visualVersion++;
+            tickCount++;
+        }
 
-            // DECORAZIONI
-            for (const auto& dec : lvl.decorations) {
-                float x0 = -1.0f + dec.x * quadSizeX;
-                float y0 = -1.0f + dec.y * quadSizeY;
-                float x1 = x0 + dec.width * quadSizeX;
-                float y1 = y0 + dec.height * quadSizeY;
-
-                drawables.push_back(Drawable{
-                    dec.render_height_y,  // base della decorazione
-                    [=]() { TextureRender::RenderTexture(dec.texturePath, x0, y0, x1, y1); },
-                    "Decorazione"
-                });
+        // Thread della logica: livello già residente o nullptr (senza caricare)
+        const Level* residentLevel(int idx) const {
+            if (idx < 0 || idx >= (int)levels.size()) return nullptr;
+            return levels[idx].level.get();
+        }
+
+        // Copia lo stato visibile nello snapshot (senza allocare dopo il primo riempimento)
+        void fillSnapshot(RenderSnapshot& snap) const {
+            snap.level = currentLevel;
+            snap.prevPlayerX = prevPlayerX;
+            snap.prevPlayerY = prevPlayerY;
+            snap.playerX = player.x;
+            snap.playerY = player.y;
+            bool playerActive = idleTime < idleThreshold;
+            snap.playerFrameX = playerActive ? player.currentFrameX : 0;
+            snap.playerFrameY = playerActive ? player.currentFrameY : 0;
+            snap.entityFrames.clear();
+            if (const Level* lvl = residentLevel(currentLevel)) {
+                for (const Entity& ent : lvl->entity) {
+                    snap.entityFrames.push_back(uint16_t(ent.currentFrameX));
+                    snap.entityFrames.push_back(uint16_t(ent.currentFrameY));
+                }
             }
-            // PORTALI
-            for (const auto& port : lvl.portals) {
-                float x0 = -1.0f + port.x * quadSizeX;
-                float y0 = -1.0f + port.y * quadSizeY;
-                float x1 = x0 + port.width * quadSizeX;
-                float y1 = y0 + port.height * quadSizeY;
-
-                drawables.push_back(Drawable{
-                    port.render_height_y,  // base del portale
-                    [=]() { TextureRender::RenderTexture(port.texturePath, x0, y0, x1, y1); },
-                    "Portale"
-                });
+            snap.fadeAlpha = transition.alpha();
+            snap.tick = tickCount;
+            snap.visualVersion = visualVersion;
+
+            // prossimo cambio previsto senza input: animazioni delle entità o fine dell'idle
+            if (transition.active() || movedLastTick || idleTime == 0.0f) {
+                snap.idleTicks = 1;
+            } else {
+                snap.idleTicks = -1;
+                if (playerActive) snap.idleTicks = ticksUntil("movement", idleTime, idleThreshold);
+                if (const Level* lvl = residentLevel(currentLevel)) {
+                    for (const Entity& ent : lvl->entity) {
+                        int ticks = ticksUntil("animation", ent.animTimer, ent.animDelay);
+                        if (snap.idleTicks < 0 || ticks < snap.idleTicks) snap.idleTicks = ticks;
+                    }
+                }
             }
+        }
 
-            // ENTITY
-            for (Entity& ent : lvl.entity) {
-                drawables.push_back(Drawable{
-                    ent.render_height_y,
-                    [&ent, quadSizeX, quadSizeY, frameTime]() {
-                        ent.renderEntity(quadSizeX, quadSizeY);
-                        ent.updateAnimation(frameTime);
-                    },
-                    "Entità"
-                });
+        // ---------- RENDERING (thread GL, legge solo lo snapshot e i dati statici) ----------
+        // alpha: frazione di passo di logica trascorsa dallo snapshot (0..1), usata per
+        // interpolare il player. Le entità sono ferme sulla griglia: cambia solo il frame.
+        void render(const RenderSnapshot& snap, float alpha) {
+            if (snap.level < 0 || snap.level >= (int)levels.size()) {
+                if (snap.level >= 0) std::cerr << "Errore: livello " << snap.level << " inesistente!\n";
+                return;
             }
 
-            // --- 3. Ordina per Y crescente ---
-            std::sort(drawables.begin(), drawables.end(),
-                    [](const Drawable& a, const Drawable& b) {
-                        return a.y > b.y;
-                    });
+            collectRetiredLevels();
+            std::shared_ptr<Level> levelRef = peekLevel(snap.level); // tiene vivo il livello durante il frame
+            accountLevelTextures();
+            if (!levelRef) return; // scaricato dopo lo snapshot (solo a schermo nero)
+            const Level& lvl = *levelRef;
+            float quadSizeX = 2.0f / lvl.width;
+            float quadSizeY = 2.0f / lvl.height;
 
-            // --- 4. Disegna in ordine ---
-            for (auto& d : drawables) {
-                //std::cout << d.name << " : Y = " << d.y << std::endl;  // debug
-                d.draw();
+            // --- 1. Renderizza il background (un draw call per texture, o un quad se in cache) ---
+            if (BACKGROUND_CACHE) {
+                // decorazioni in cache disegnate con il segnaposto: rifare quando arriva la texture vera
+                if (BACKGROUND_CACHE_DECORATIONS && cachedTextureGeneration != TextureRender::textureGeneration) {
+                    backgroundCache.invalidate();
+                    cachedTextureGeneration = TextureRender::textureGeneration;
+                }
+                backgroundCache.draw(snap.level, [&]() {
+                    lvl.drawBackground();
+                    if (BACKGROUND_CACHE_DECORATIONS) renderStaticDecorations(lvl);
+                });
+            } else {
+                lvl.drawBackground();
             }
-            
-            // controlliamo se il player interagisce con un portale
-            for (const auto& port : getLevel(lvl_number).portals) {
-                #define MARGIN_PORTAL_X 0.12f
-                #define MARGIN_PORTAL_Y 0.3f
-                //se la x,y del player sono vicine alla x,y del portale allora 
-                //carica il nuovo livello
-                if (port.render_height_x * (1.0f - MARGIN_PORTAL_X) <= player.x && port.render_height_x * (1.0f + MARGIN_PORTAL_X) >= player.x){
-                    //se il player e' nel margine del portale
-                    if (port.render_height_y * (1.0f - ((port.height <=2) ? MARGIN_PORTAL_Y : 0.05f)) <= player.y && port.render_height_y * (1.0f) >= player.y){
-                        //se il player e' nel margine anche delle y del portale
-                        printf("INTERAZIONE PORTALE!!!!! \n");
-                        auto it = LevelMap.find(port.path_new_level);
-                        if (it != LevelMap.end()) {
-                            std::cout << "Cambio scena, nuovo livello = " << it->first << std::endl;
-                            std::cout << "SPOSTO PLAYER A: x= " << port.new_player_x_cord << "; y= " << port.new_player_y_cord << std::endl;
-                            lvl_number = it->second;
-                            player.x = port.new_player_x_cord;
-                            player.y = port.new_player_y_cord;
-                            //TODO: sistemare animazioni dopo passaggio portale
+            const bool decorationsCached = BACKGROUND_CACHE && BACKGROUND_CACHE_DECORATIONS;
 
-                            TextureRender::RenderBlackTransition(1.0f, -1.0f, -1.0f, 1.0f, 1.0f);
-                        } else {
-                            std::cerr << "ERRORE GRAVE: livello non trovato nella HashMap! (" << port.path_new_level << ")" << std::endl;
-                        }
+            // --- 2. Raccogli i comandi di disegno (buffer riutilizzato, nessuna allocazione) ---
+            drawList.clear();
 
-                    }
+            // PLAYER
+            pushPlayer(snap, alpha);
 
-                }
+            // DECORAZIONI E PORTALI
+            if (!decorationsCached) {
+                for (const auto& dec : lvl.decorations) pushDecoration(dec, quadSizeX, quadSizeY);
+                for (const auto& port : lvl.portals) pushDecoration(port, quadSizeX, quadSizeY);
             }
+
+            // ENTITY
+            for (size_t i = 0; i < lvl.entity.size() && i * 2 + 1 < snap.entityFrames.size(); i++) {
+                lvl.entity[i].pushDraw(drawList, quadSizeX, quadSizeY,
+                                       snap.entityFrames[i * 2], snap.entityFrames[i * 2 + 1]);
+            }
+
+            // --- 3. Ordina per Y decrescente (chi sta più in alto va dietro) ---
+            drawList.sort();
+
+            // --- 4. Disegna in ordine, raggruppando per texture (instancing se disponibile) ---
+            spriteRenderer.submit(drawList);
+
+            // --- 5. Velo della transizione tra livelli ---
+            TextureRender::RenderBlackTransition(snap.fadeAlpha, -1.0f, -1.0f, 1.0f, 1.0f);
         }
 };
 
+// Con LAZY_LEVELS registra solo i path (il parsing avviene al primo accesso). Altrimenti
+// parsing dei livelli in parallelo sul thread pool; l'unione (id) avviene sul thread
+// principale in ordine di path, così gli id dei livelli non dipendono né dall'ordine
+// della directory né da quale worker finisce prima.
 void loadAllLevels(GameManager& gameManager, const std::string& folder, int gridX, int gridY) {
-    namespace fs = std::filesystem;
+    std::vector<std::string> paths = listLevelPaths(folder);
 
-    try {
-        for (const auto& entry : fs::directory_iterator(folder)) {
-            if (entry.is_regular_file() && entry.path().extension() == ".txt") {
-                gameManager.addLevel(entry.path().string(), gridX, gridY);
-            }
+    if (LAZY_LEVELS) {
+        for (const std::string& path : paths) gameManager.registerLevel(path, gridX, gridY);
+        return;
+    }
+
+    struct ParsedLevel {
+        Level level;
+        std::ostringstream log;
+        bool ok = false;
+        ParsedLevel(int w, int h) : level(w, h) {}
+    };
+    std::vector<std::unique_ptr<ParsedLevel>> parsed;
+    parsed.reserve(paths.size());
+    for (size_t i = 0; i < paths.size(); i++) parsed.emplace_back(new ParsedLevel(gridX, gridY));
+
+    {
+        ThreadPool pool(LEVEL_LOAD_THREADS);
+        for (size_t i = 0; i < paths.size(); i++) {
+            pool.submit([&paths, &parsed, i]() {
+                ParsedLevel& p = *parsed[i];
+                p.ok = readLevel(paths[i], p.level, p.log);
+            });
+        }
+        pool.waitIdle();
+    }
+
+    for (size_t i = 0; i < paths.size(); i++) {
+        std::cout << parsed[i]->log.str();
+        if (!parsed[i]->ok) {
+            std::cerr << "Errore: impossibile aprire " << paths[i] << std::endl;
+            exit(1);
         }
-    } catch (const fs::filesystem_error& e) {
-        std::cerr << "Errore nell'accesso alla cartella " << folder 
-                  << ": " << e.what() << std::endl;
+        gameManager.addLevel(paths[i], std::move(parsed[i]->level));
+        parsed[i].reset(); // libera subito la copia del worker
     }
 }
 
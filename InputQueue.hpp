@@ -0,0 +1,67 @@
+#ifndef INPUT_QUEUE_HPP
+#define INPUT_QUEUE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Orologio comune a input e logica (secondi, monotono)
+inline double SteadyTime() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ---------- INPUT EVENT ----------
+enum InputKey : uint8_t { KEY_UP = 0, KEY_DOWN = 1, KEY_LEFT = 2, KEY_RIGHT = 3 };
+
+struct InputEvent {
+    double time;    // SteadyTime() alla ricezione della callback
+    uint8_t key;    // InputKey
+    bool pressed;   // true = premuto, false = rilasciato
+};
+
+// ---------- INPUT QUEUE ----------
+// Coda circolare lock-free a produttore singolo (callback GLFW, thread principale) e
+// consumatore singolo (passo di logica). Le transizioni dei tasti non vanno perse anche
+// se durano meno di un frame; a coda piena gli eventi nuovi vengono scartati e contati.
+class InputQueue {
+public:
+    static const uint32_t CAPACITY = 256; // potenza di 2
+
+    bool push(const InputEvent& event) {
+        uint32_t head = headIndex.load(std::memory_order_relaxed);
+        uint32_t tail = tailIndex.load(std::memory_order_acquire);
+        if (head - tail >= CAPACITY) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        events[head & (CAPACITY - 1)] = event;
+        headIndex.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Estrae il prossimo evento solo se è avvenuto entro until
+    bool popUntil(double until, InputEvent& out) {
+        uint32_t tail = tailIndex.load(std::memory_order_relaxed);
+        if (tail == headIndex.load(std::memory_order_acquire)) return false;
+        const InputEvent& event = events[tail & (CAPACITY - 1)];
+        if (event.time > until) return false;
+        out = event;
+        tailIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Eventi non ancora consumati dalla logica (indicativo se letto dal produttore)
+    bool pending() const {
+        return tailIndex.load(std::memory_order_acquire) != headIndex.load(std::memory_order_acquire);
+    }
+
+    unsigned long droppedEvents() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    InputEvent events[CAPACITY];
+    std::atomic<uint32_t> headIndex{0}; // scritto dal produttore
+    std::atomic<uint32_t> tailIndex{0}; // scritto dal consumatore
+    std::atomic<unsigned long> dropped{0};
+};
+
+#endif // INPUT_QUEUE_HPP
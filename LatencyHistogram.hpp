@@ -0,0 +1,64 @@
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <string>
+#include <fstream>
+#include <algorithm>
+
+// ---------- LATENCY HISTOGRAM ----------
+// Istogramma delle latenze input -> schermo: bucket da 1 ms fino a MAX_MS, più un
+// bucket finale per tutto ciò che sfora. Nessuna allocazione durante la partita;
+// all'uscita si esporta in CSV per confrontare le modalità di pacing.
+struct LatencyHistogram {
+    static constexpr int MAX_MS = 200;
+
+    unsigned long buckets[MAX_MS + 1] = {}; // [i] = latenze in [i, i+1) ms, [MAX_MS] = oltre
+    unsigned long samples = 0;
+    double total = 0.0, minimum = 0.0, maximum = 0.0; // secondi
+
+    void add(double seconds) {
+        seconds = std::max(seconds, 0.0);
+        int bucket = std::min(int(seconds * 1000.0), MAX_MS);
+        buckets[bucket]++;
+        minimum = samples ? std::min(minimum, seconds) : seconds;
+        maximum = std::max(maximum, seconds);
+        total += seconds;
+        samples++;
+    }
+
+    double average() const {
+        return samples ? total / samples : 0.0;
+    }
+
+    // Percentile (0..1) in ms, risolto al bucket: limite superiore del bucket che lo contiene
+    double percentileMs(double p) const {
+        if (!samples) return 0.0;
+        unsigned long rank = (unsigned long)(p * (samples - 1)) + 1;
+        unsigned long seen = 0;
+        for (int i = 0; i <= MAX_MS; i++) {
+            seen += buckets[i];
+            if (seen >= rank) return i + 1.0;
+        }
+        return MAX_MS + 1.0;
+    }
+
+    // CSV: righe di commento con la configurazione e il riepilogo, poi bucket_ms,count
+    bool exportCsv(const std::string& path, const std::string& description) const {
+        std::ofstream out(path);
+        if (!out) return false;
+        out << "# " << description << "\n";
+        out << "# samples=" << samples
+            << " avg_ms=" << average() * 1000.0
+            << " min_ms=" << minimum * 1000.0
+            << " max_ms=" << maximum * 1000.0
+            << " p50_ms<=" << percentileMs(0.50)
+            << " p95_ms<=" << percentileMs(0.95)
+            << " p99_ms<=" << percentileMs(0.99) << "\n";
+        out << "bucket_ms,count\n";
+        for (int i = 0; i < MAX_MS; i++) out << i << "," << buckets[i] << "\n";
+        out << ">=" << MAX_MS << "," << buckets[MAX_MS] << "\n";
+        return bool(out);
+    }
+};
+
+#endif // LATENCY_HISTOGRAM_HPP
@@ -0,0 +1,118 @@
+#ifndef LEVEL_FORMAT_HPP
+#define LEVEL_FORMAT_HPP
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include "MappedFile.hpp"
+
+// ---------- FORMATO BINARIO DEI LIVELLI ----------
+// File .lvlb prodotti da levelc a partire dai .txt: tutto ciò che il parser calcola
+// (hitbox, altezze di rendering, path delle texture dei tile, indice del livello di
+// destinazione dei portali) è già pronto. Il file si mappa in memoria e i record si
+// copiano così come sono; nessuna conversione di testo all'avvio.
+//
+// Struttura: Header, poi le sezioni (array di record a dimensione fissa, allineati a 4
+// byte) e infine la tabella delle stringhe (stringhe terminate da zero, senza
+// duplicati). Le texture sono indici nella sezione textures, che contiene gli offset
+// delle path nella tabella delle stringhe. Byte order nativo: il file si rigenera sulla
+// macchina (o sulla famiglia di macchine) che lo usa, endianTag lo verifica.
+namespace LevelFormat {
+
+    const char MAGIC[4] = {'T', 'W', 'L', 'V'};
+    const uint32_t VERSION = 2;               // da incrementare a ogni cambio dei record
+    const uint32_t PARSER_REVISION = 1;       // da incrementare a ogni cambio di parseLevelFile (hitbox, fallback, ...)
+    const uint32_t ENDIAN_TAG = 0x01020304u;
+    const uint32_t NONE = 0xFFFFFFFFu;        // texture o livello assente
+
+    struct Section {
+        uint32_t offset;  // byte dall'inizio del file
+        uint32_t count;   // record (byte per la tabella delle stringhe)
+    };
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t endianTag;
+        int32_t width, height;  // tile del livello
+        int32_t gridSize;       // GRID_SIZE usato per le hitbox
+        uint32_t parserRevision; // PARSER_REVISION del parser che ha prodotto i record
+        uint32_t levelCount;    // livelli nella cartella alla compilazione (indici dei portali)
+        Section textures;       // uint32_t: offset della path nella tabella delle stringhe
+        Section tiles;          // TileRecord, width*height in ordine di riga
+        Section decorations;    // DecorationRecord
+        Section portals;        // PortalRecord
+        Section entities;       // EntityRecord
+        Section hitboxes;       // HitboxRecord, nell'ordine delle righe del .txt
+        Section strings;        // tabella delle stringhe
+    };
+
+    struct TileRecord {
+        int32_t id;
+        uint32_t texture;       // indice in textures, NONE = riga mancante nel .txt
+    };
+
+    struct DecorationRecord {
+        uint32_t texture;
+        float x, y, width, height;
+        float renderHeightY;
+    };
+
+    struct PortalRecord {
+        DecorationRecord base;
+        uint32_t targetPath;    // offset nella tabella delle stringhe
+        uint32_t targetLevel;   // id del livello di destinazione, NONE se non trovato
+        int32_t newPlayerX, newPlayerY;
+        float renderHeightX;
+    };
+
+    struct EntityRecord {
+        uint32_t texture;
+        int32_t x, y;
+        float width, height;
+        float scaleX, scaleY;
+        int32_t frameWidth, frameHeight;
+        int32_t framesPerRow, framesPerCol;
+        int32_t currentFrameX, stopFrameY;
+        float renderHeightY;
+    };
+
+    struct HitboxRecord {
+        float x0, y0, x1, y1;
+    };
+
+    // Controlla che header, sezioni e stringhe stiano dentro il file (size byte a data)
+    inline bool Validate(const unsigned char* data, size_t size, std::string& error) {
+        if (size < sizeof(Header)) { error = "file troppo corto"; return false; }
+        Header h;
+        std::memcpy(&h, data, sizeof(h));
+        if (std::memcmp(h.magic, MAGIC, 4) != 0) { error = "non e' un livello compilato"; return false; }
+        if (h.endianTag != ENDIAN_TAG) { error = "byte order diverso"; return false; }
+        if (h.version != VERSION) { error = "versione " + std::to_string(h.version) + " non supportata"; return false; }
+
+        const Section* sections[] = {&h.textures, &h.tiles, &h.decorations, &h.portals, &h.entities, &h.hitboxes, &h.strings};
+        const size_t recordSizes[] = {sizeof(uint32_t), sizeof(TileRecord), sizeof(DecorationRecord), sizeof(PortalRecord),
+                                      sizeof(EntityRecord), sizeof(HitboxRecord), 1};
+        for (int i = 0; i < 7; i++) {
+            uint64_t end = uint64_t(sections[i]->offset) + uint64_t(sections[i]->count) * recordSizes[i];
+            if (sections[i]->offset % 4 != 0 || end > size) { error = "sezione fuori dal file"; return false; }
+        }
+        if (h.width <= 0 || h.height <= 0 || h.tiles.count != uint32_t(h.width) * uint32_t(h.height)) {
+            error = "dimensioni incoerenti";
+            return false;
+        }
+        if (h.strings.count == 0 || data[h.strings.offset + h.strings.count - 1] != 0) {
+            error = "tabella delle stringhe non terminata";
+            return false;
+        }
+        const uint32_t* textures = reinterpret_cast<const uint32_t*>(data + h.textures.offset);
+        for (uint32_t i = 0; i < h.textures.count; i++) {
+            if (textures[i] >= h.strings.count) { error = "path di texture fuori tabella"; return false; }
+        }
+        return true;
+    }
+
+} // namespace LevelFormat
+
+#endif // LEVEL_FORMAT_HPP
@@ -0,0 +1,69 @@
+#ifndef SHADER_HPP
+#define SHADER_HPP
+
+#include <GL/glew.h>
+#include <iostream>
+#include <vector>
+#include <utility>
+
+// ---------- SHADER ----------
+// Compilazione e link di programmi GLSL (1.20, compatibili con GL 2.1).
+// In caso di errore stampa il log e restituisce 0: il chiamante ripiega sul fixed pipeline.
+namespace Shader {
+
+    inline bool Available() {
+        return GLEW_VERSION_2_0;
+    }
+
+    inline GLuint Compile(GLenum type, const char* source) {
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, nullptr);
+        glCompileShader(shader);
+
+        GLint ok = GL_FALSE;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+        if (!ok) {
+            char log[1024];
+            glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+            std::cerr << "Errore compilazione shader: " << log << std::endl;
+            glDeleteShader(shader);
+            return 0;
+        }
+        return shader;
+    }
+
+    // attributes: nome -> location, da legare prima del link
+    inline GLuint Link(const char* vertexSource, const char* fragmentSource,
+                       const std::vector<std::pair<GLuint, const char*>>& attributes = {}) {
+        if (!Available()) return 0;
+        GLuint vs = Compile(GL_VERTEX_SHADER, vertexSource);
+        GLuint fs = Compile(GL_FRAGMENT_SHADER, fragmentSource);
+        if (!vs || !fs) {
+            if (vs) glDeleteShader(vs);
+            if (fs) glDeleteShader(fs);
+            return 0;
+        }
+
+        GLuint program = glCreateProgram();
+        glAttachShader(program, vs);
+        glAttachShader(program, fs);
+        for (const auto& attribute : attributes) glBindAttribLocation(program, attribute.first, attribute.second);
+        glLinkProgram(program);
+        glDeleteShader(vs); // restano attaccati al programma
+        glDeleteShader(fs);
+
+        GLint ok = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &ok);
+        if (!ok) {
+            char log[1024];
+            glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+            std::cerr << "Errore link shader: " << log << std::endl;
+            glDeleteProgram(program);
+            return 0;
+        }
+        return program;
+    }
+
+} // namespace Shader
+
+#endif // SHADER_HPP
@@ -0,0 +1,184 @@
+#ifndef SIMULATION_HPP
+#define SIMULATION_HPP
+
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include "Variable.hpp"
+#include "GameManager.hpp"
+#include "TripleBuffer.hpp"
+#include "InputQueue.hpp"
+#include <GLFW/glfw3.h> // glfwPostEmptyEvent per svegliare il thread GL
+
+// ---------- SIMULATION ----------
+// Logica a passo fisso (movimento, animazione entità, portali) separata dal rendering.
+// Dopo ogni passo lo stato visibile viene pubblicato in un triple buffer lock-free che
+// il thread GL legge senza mai aspettare. Con LOGIC_THREAD la logica gira su un thread
+// proprio a HZ fissi; altrimenti advance() esegue i passi dal loop principale.
+// L'input arriva dalla coda di eventi: ogni passo applica solo gli eventi avvenuti
+// fino al proprio istante, quindi ogni cambio di tasto cade nel passo giusto.
+// Quando lo stato visibile cambia, il thread della logica sveglia il thread GL che
+// attende in glfwWaitEventsTimeout (frame inattivi, IDLE_SKIP).
+// Latenza input -> schermo: lo snapshot porta l'istante del più vecchio evento consumato
+// e non ancora presentato; il thread GL lo conferma dopo lo swap con inputPresented().
+class Simulation {
+public:
+    Simulation(GameManager& game, InputQueue& input, double dt) : game(game), input(input), dt(dt) {}
+    ~Simulation() { stop(); }
+
+    // Modalità a thread singolo: esegue i passi maturati in frameTime secondi
+    void advance(double frameTime) {
+        accumulator += frameTime;
+        accumulator = std::min(accumulator, MAX_CATCH_UP); // niente spirale dopo uno stallo lungo
+        const double frameEnd = SteadyTime();
+        bool stepped = !published;
+        while (accumulator >= dt) {
+            accumulator -= dt;
+            step(frameEnd - accumulator); // istante che il passo rappresenta
+            stepped = true;
+        }
+        if (stepped) publish();
+    }
+
+    void start() {
+        if (running) return;
+        publish();
+        running = true;
+        thread = std::thread([this]() { run(); });
+    }
+
+    void stop() {
+        if (!running) return;
+        running = false;
+        thread.join();
+    }
+
+    // Thread GL: ultimo snapshot pubblicato
+    const RenderSnapshot& latest() { return snapshots.read(); }
+
+    // Frazione di passo trascorsa dallo snapshot, per interpolare tra stato precedente e corrente
+    float interpolationAlpha(const RenderSnapshot& snap) const {
+        double elapsed = LOGIC_THREAD ? SteadyTime() - snap.publishTime : accumulator;
+        return float(std::min(std::max(elapsed / dt, 0.0), 1.0));
+    }
+
+    // Secondi che il thread GL può attendere con lo snapshot invariato: fino al passo che
+    // produrrà il prossimo cambio previsto, al massimo IDLE_MAX_WAIT. Con il thread della
+    // logica il risveglio arriva comunque da glfwPostEmptyEvent: il timeout è solo una rete.
+    double idleTimeout(const RenderSnapshot& snap) const {
+        double wait = IDLE_MAX_WAIT;
+        if (snap.idleTicks >= 0) {
+            double elapsed = LOGIC_THREAD ? SteadyTime() - snap.publishTime : accumulator;
+            double margin = LOGIC_THREAD ? dt : 0.0;
+            wait = std::min(wait, snap.idleTicks * dt - elapsed + margin);
+        }
+        return std::max(wait, 0.0);
+    }
+
+    // Lo snapshot contiene input consumato che non è ancora arrivato a schermo
+    bool inputPending(const RenderSnapshot& snap) const {
+        return snap.inputSerial > presentedSerial.load(std::memory_order_relaxed);
+    }
+
+    // Thread GL, subito dopo lo swap dello snapshot: latenza in secondi dal più vecchio
+    // evento non ancora presentato, o -1 se lo snapshot non porta input nuovo.
+    // Gli eventi consumati nello stesso frame danno un solo campione (il peggiore).
+    double inputPresented(const RenderSnapshot& snap, double presentTime) {
+        if (!inputPending(snap)) return -1.0;
+        presentedSerial.store(snap.inputSerial, std::memory_order_release);
+        return snap.inputTime > 0.0 ? presentTime - snap.inputTime : -1.0;
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    static constexpr double MAX_CATCH_UP = 0.25; // secondi di logica recuperabili in un colpo
+
+    GameManager& game;
+    InputQueue& input;
+    const double dt;
+    double accumulator = 0.0;
+    bool published = false;
+    uint64_t publishedVersion = 0; // visualVersion dell'ultimo snapshot pubblicato
+    uint64_t notifiedVersion = 0;  // ultima visualVersion segnalata al thread GL
+    uint64_t inputSerial = 0;      // eventi consumati (solo thread della logica)
+    uint64_t pendingSerial = 0;    // primo evento non ancora presentato
+    double pendingInputTime = 0.0; // suo istante (0 = nessuno in attesa)
+    uint64_t notifiedSerial = 0;
+    std::atomic<uint64_t> presentedSerial{0}; // scritto dal thread GL dopo lo swap
+    uint8_t heldKeys = 0; // bit per InputKey, solo thread della logica
+    TripleBuffer<RenderSnapshot> snapshots;
+    std::thread thread;
+    std::atomic<bool> running{false};
+
+    // Un passo di logica all'istante tickTime. Un tasto premuto e rilasciato dentro lo
+    // stesso passo conta comunque come premuto per quel passo.
+    void step(double tickTime) {
+        // l'evento in attesa è arrivato a schermo: si può seguire il prossimo
+        if (pendingInputTime > 0.0 && presentedSerial.load(std::memory_order_acquire) >= pendingSerial)
+            pendingInputTime = 0.0;
+
+        uint8_t pressedThisTick = 0;
+        InputEvent event;
+        while (input.popUntil(tickTime, event)) {
+            inputSerial++;
+            if (pendingInputTime <= 0.0) {
+                pendingInputTime = event.time;
+                pendingSerial = inputSerial;
+            }
+            uint8_t bit = uint8_t(1u << event.key);
+            if (event.pressed) {
+                heldKeys |= bit;
+                pressedThisTick |= bit;
+            } else {
+                heldKeys &= uint8_t(~bit);
+            }
+        }
+
+        uint8_t keys = heldKeys | pressedThisTick;
+        PlayerInput state;
+        state.up    = keys & (1u << KEY_UP);
+        state.down  = keys & (1u << KEY_DOWN);
+        state.left  = keys & (1u << KEY_LEFT);
+        state.right = keys & (1u << KEY_RIGHT);
+        game.update(float(dt), state);
+    }
+
+    void publish() {
+        RenderSnapshot& snap = snapshots.writeBuffer();
+        game.fillSnapshot(snap);
+        snap.publishTime = SteadyTime();
+        snap.inputSerial = inputSerial;
+        snap.inputTime = pendingInputTime;
+        publishedVersion = snap.visualVersion;
+        snapshots.publish();
+        published = true;
+    }
+
+    // Il thread GL potrebbe dormire su un frame inattivo: lo si sveglia solo se serve
+    // (immagine cambiata o input da presentare per la misura della latenza)
+    void wakeRenderer() {
+        if (!IDLE_SKIP) return;
+        if (publishedVersion == notifiedVersion && inputSerial == notifiedSerial) return;
+        notifiedVersion = publishedVersion;
+        notifiedSerial = inputSerial;
+        glfwPostEmptyEvent();
+    }
+
+    void run() {
+        const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(dt));
+        const auto maxLag = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(MAX_CATCH_UP));
+        auto next = Clock::now();
+        while (running) {
+            step(SteadyTime());
+            publish();
+            wakeRenderer();
+            next += period;
+            auto now = Clock::now();
+            if (now - next > maxLag) next = now; // troppo indietro: si riparte da adesso
+            std::this_thread::sleep_until(next);
+        }
+    }
+};
+
+#endif // SIMULATION_HPP
@@ -0,0 +1,170 @@
+#ifndef SPRITE_RENDERER_HPP
+#define SPRITE_RENDERER_HPP
+
+#include <GL/glew.h>
+#include <vector>
+#include <cstddef> // offsetof
+#include "Variable.hpp"
+#include "Shader.hpp"
+#include "DrawList.hpp"
+
+// ---------- SPRITE RENDERER ----------
+// Disegna la draw list con l'instancing: un quad condiviso e, per ogni sprite, solo
+// posizione/dimensione, frame, dimensioni dello sheet e regione della texture.
+// I comandi consecutivi sulla stessa texture GL diventano un glDrawArraysInstanced.
+// Senza instancing (o se lo shader non compila) si usa DrawList::submit, che espande i quad sulla CPU.
+struct SpriteRenderer {
+    struct Instance {
+        float rect[4];    // x0, y0, larghezza, altezza (NDC)
+        float frame[4];   // frameX, frameY, colonne, righe dello sheet
+        float region[4];  // u0, v0, u1, v1 della texture o della regione nell'atlas
+    };
+    struct Batch {
+        GLuint texture;
+        bool opaque;      // disegnato senza blending
+        GLint first;      // prima istanza
+        GLsizei count;
+    };
+
+    enum Attribute : GLuint { CORNER = 0, RECT = 1, FRAME = 2, REGION = 3 };
+
+    GLuint program = 0;
+    GLuint quadVbo = 0, instanceVbo = 0;
+    GLint textureUniform = -1;
+    bool initialized = false;
+    bool arbInstancing = false; // GL < 3.3: entry point ARB
+    std::vector<Instance> instances;
+    std::vector<Batch> batches;
+
+    static bool Supported() {
+        return Shader::Available() &&
+               (GLEW_VERSION_3_3 || (GLEW_ARB_instanced_arrays && GLEW_ARB_draw_instanced));
+    }
+
+    bool available() {
+        if (!initialized) init();
+        return program != 0;
+    }
+
+    void submit(DrawList& list) {
+        if (!SPRITE_INSTANCING || !available()) {
+            list.submit();
+            return;
+        }
+        if (list.commands.empty()) return;
+
+        // 1. dati per istanza, raggruppati per texture GL
+        instances.clear();
+        batches.clear();
+        for (const DrawCommand& c : list.commands) {
+            const TextureAtlas::Region& r = TextureRender::GetRegion(c.texture);
+            if (r.texture == 0) continue; // errore nel caricamento
+            if (batches.empty() || batches.back().texture != r.texture || batches.back().opaque != r.opaque) {
+                batches.push_back(Batch{r.texture, r.opaque, GLint(instances.size()), 0});
+            }
+            instances.push_back(Instance{
+                {c.x0, c.y0, c.x1 - c.x0, c.y1 - c.y0},
+                {float(c.frameX), float(c.frameY), float(c.framesPerRow), float(c.framesPerCol)},
+                {r.u0, r.v0, r.u1, r.v1}
+            });
+            batches.back().count++;
+        }
+        if (batches.empty()) return;
+
+        // 2. upload unico dei dati del frame (orphaning del buffer precedente)
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+        glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(Instance), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(Instance), instances.data());
+
+        glUseProgram(program);
+        glUniform1i(textureUniform, 0);
+
+        glBindBuffer(GL_ARRAY_BUFFER, quadVbo);
+        glEnableVertexAttribArray(CORNER);
+        glVertexAttribPointer(CORNER, 2, GL_FLOAT, GL_FALSE, 0, (const GLvoid*)0);
+
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+        for (GLuint attribute : {RECT, FRAME, REGION}) {
+            glEnableVertexAttribArray(attribute);
+            setDivisor(attribute, 1);
+        }
+
+        // 3. un draw call instanziato per batch (senza base instance si sposta l'offset degli attributi)
+        for (const Batch& b : batches) {
+            const size_t offset = size_t(b.first) * sizeof(Instance);
+            glVertexAttribPointer(RECT,   4, GL_FLOAT, GL_FALSE, sizeof(Instance), (const GLvoid*)(offset + offsetof(Instance, rect)));
+            glVertexAttribPointer(FRAME,  4, GL_FLOAT, GL_FALSE, sizeof(Instance), (const GLvoid*)(offset + offsetof(Instance, frame)));
+            glVertexAttribPointer(REGION, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (const GLvoid*)(offset + offsetof(Instance, region)));
+            TextureRender::SetEnabled(GL_BLEND, !b.opaque);
+            TextureRender::BindTexture(b.texture);
+            if (arbInstancing) glDrawArraysInstancedARB(GL_TRIANGLE_STRIP, 0, 4, b.count);
+            else glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, b.count);
+        }
+
+        // ripristina lo stato per il fixed pipeline
+        TextureRender::Enable(GL_BLEND);
+        for (GLuint attribute : {RECT, FRAME, REGION}) {
+            setDivisor(attribute, 0);
+            glDisableVertexAttribArray(attribute);
+        }
+        glDisableVertexAttribArray(CORNER);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glUseProgram(0);
+    }
+
+    void release() {
+        if (program) glDeleteProgram(program);
+        if (quadVbo) glDeleteBuffers(1, &quadVbo);
+        if (instanceVbo) glDeleteBuffers(1, &instanceVbo);
+        program = quadVbo = instanceVbo = 0;
+        initialized = false;
+    }
+
+private:
+    void setDivisor(GLuint attribute, GLuint divisor) {
+        if (arbInstancing) glVertexAttribDivisorARB(attribute, divisor);
+        else glVertexAttribDivisor(attribute, divisor);
+    }
+
+    void init() {
+        initialized = true;
+        if (!SPRITE_INSTANCING || !Supported()) return;
+        arbInstancing = !GLEW_VERSION_3_3;
+
+        // UV: v cresce verso il basso nell'immagine, y verso l'alto sullo schermo
+        const char* vertexSource = R"(
+            #version 120
+            attribute vec2 a_corner;
+            attribute vec4 a_rect;
+            attribute vec4 a_frame;
+            attribute vec4 a_region;
+            varying vec2 v_uv;
+            void main() {
+                gl_Position = vec4(a_rect.xy + a_corner * a_rect.zw, 0.0, 1.0);
+                vec2 cell = (a_frame.xy + vec2(a_corner.x, 1.0 - a_corner.y)) / a_frame.zw;
+                v_uv = mix(a_region.xy, a_region.zw, cell);
+            }
+        )";
+        const char* fragmentSource = R"(
+            #version 120
+            uniform sampler2D u_texture;
+            varying vec2 v_uv;
+            void main() {
+                gl_FragColor = texture2D(u_texture, v_uv);
+            }
+        )";
+        program = Shader::Link(vertexSource, fragmentSource,
+                               {{CORNER, "a_corner"}, {RECT, "a_rect"}, {FRAME, "a_frame"}, {REGION, "a_region"}});
+        if (!program) return;
+        textureUniform = glGetUniformLocation(program, "u_texture");
+
+        const float corners[8] = {0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f}; // triangle strip
+        glGenBuffers(1, &quadVbo);
+        glBindBuffer(GL_ARRAY_BUFFER, quadVbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+        glGenBuffers(1, &instanceVbo);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+};
+
+#endif // SPRITE_RENDERER_HPP
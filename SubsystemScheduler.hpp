@@ -0,0 +1,66 @@
+#ifndef SUBSYSTEM_SCHEDULER_HPP
+#define SUBSYSTEM_SCHEDULER_HPP
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <algorithm>
+
+// ---------- SUBSYSTEM SCHEDULER ----------
+// Ogni sottosistema della logica (movimento, animazioni, portali, AI...) si registra con
+// la propria frequenza e un proprio accumulatore. A ogni passo base si avanzano tutti,
+// nell'ordine di registrazione, eseguendo i tick maturati con un dt fisso (1 / frequenza):
+// la logica costosa può girare meno spesso e il risultato non dipende dal frame rate.
+// Una frequenza più alta di quella del passo base esegue più tick nello stesso passo.
+class SubsystemScheduler {
+public:
+    typedef std::function<void(float)> TickFn;
+
+    struct Subsystem {
+        std::string name;
+        double period;          // secondi tra un tick e l'altro
+        double accumulator;
+        unsigned long ticks;    // tick eseguiti (statistiche)
+        TickFn tick;
+    };
+
+    // Registra un sottosistema a hz tick al secondo; l'ordine di registrazione è l'ordine di esecuzione
+    void add(const std::string& name, double hz, TickFn tick) {
+        subsystems.push_back(Subsystem{name, 1.0 / hz, 0.0, 0, tick});
+    }
+
+    // Avanza tutti i sottosistemi di dt secondi
+    void advance(double dt) {
+        for (Subsystem& sub : subsystems) {
+            sub.accumulator += dt;
+            // tolleranza: un passo base di 1/60 accumulato 2 volte non deve mancare un tick a 30 Hz
+            while (sub.accumulator >= sub.period - 1e-9) {
+                sub.accumulator -= sub.period;
+                sub.tick(float(sub.period));
+                sub.ticks++;
+            }
+        }
+    }
+
+    // Secondi di passi base prima che il sottosistema esegua il suo ticks-esimo tick da
+    // adesso (tiene conto di quanto ha già accumulato); -1 se non è registrato
+    double timeUntilTick(const std::string& name, unsigned ticks) const {
+        for (const Subsystem& sub : subsystems) {
+            if (sub.name == name) return std::max(0.0, ticks * sub.period - sub.accumulator);
+        }
+        return -1.0;
+    }
+
+    // Secondi tra due tick del sottosistema; 0 se non è registrato
+    double periodOf(const std::string& name) const {
+        for (const Subsystem& sub : subsystems) {
+            if (sub.name == name) return sub.period;
+        }
+        return 0.0;
+    }
+
+private:
+    std::vector<Subsystem> subsystems;
+};
+
+#endif // SUBSYSTEM_SCHEDULER_HPP
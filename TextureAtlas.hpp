@@ -0,0 +1,179 @@
+#ifndef TEXTURE_ATLAS_HPP
+#define TEXTURE_ATLAS_HPP
+
+#include <GL/glew.h>
+#include <iostream>
+#include <unordered_map>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include "Variable.hpp"
+#include "GLState.hpp"
+#include "TextureResample.hpp"
+#include "AssetPack.hpp"
+// stb_image viene incluso da TextureLoader.hpp (che contiene anche l'implementazione)
+
+// ---------- TEXTURE ATLAS ----------
+// Impacchetta molte texture piccole (tile, decorazioni, slice dei mobili) in poche
+// pagine grandi. Ogni path diventa una regione UV dentro una pagina, così un intero
+// livello si disegna quasi senza cambi di texture.
+namespace TextureAtlas {
+
+    struct Region {
+        GLuint texture;           // pagina dell'atlas
+        float u0, v0, u1, v1;     // rettangolo UV (v0 = riga in alto dell'immagine)
+        bool opaque = false;      // nessun pixel trasparente: si può disegnare senza blending
+    };
+
+    // true se l'immagine non ha pixel con alpha < 255 (senza canale alpha è sempre opaca)
+    inline bool IsOpaque(const unsigned char* pixels, int width, int height, int channels) {
+        if (channels != 2 && channels != 4) return true;
+        const size_t count = size_t(width) * height;
+        for (size_t i = 0; i < count; i++) {
+            if (pixels[i * channels + channels - 1] != 255) return false;
+        }
+        return true;
+    }
+
+    // Pagine caricate e regioni per path
+    static std::vector<GLuint> pages;
+    static std::unordered_map<std::string, Region> regions;
+
+    inline bool Find(const std::string& filename, Region& out) {
+        auto it = regions.find(filename);
+        if (it == regions.end()) return false;
+        out = it->second;
+        return true;
+    }
+
+    // Toglie la path dall'atlas (la pagina resta): da qui in poi è una texture singola
+    inline bool Remove(const std::string& filename) {
+        return regions.erase(filename) > 0;
+    }
+
+    // Copia l'immagine nella pagina ed estende i bordi nel padding (evita il
+    // bleeding tra regioni vicine con il filtro GL_LINEAR)
+    inline void Blit(std::vector<unsigned char>& page, int pageSize,
+                     const unsigned char* image, int w, int h, int px, int py) {
+        const int pad = ATLAS_PADDING;
+        for (int y = -pad; y < h + pad; y++) {
+            int sy = std::min(std::max(y, 0), h - 1);
+            for (int x = -pad; x < w + pad; x++) {
+                int sx = std::min(std::max(x, 0), w - 1);
+                std::memcpy(&page[((py + y) * pageSize + (px + x)) * 4], &image[(sy * w + sx) * 4], 4);
+            }
+        }
+    }
+
+    inline GLuint UploadPage(const std::vector<unsigned char>& page, int pageSize) {
+        GLuint textureID;
+        glGenTextures(1, &textureID);
+        TextureRender::BindTexture(textureID);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        // mipmap solo finché il padding separa ancora le regioni (1 pixel per livello)
+        int maxLevel = 0;
+        while ((2 << maxLevel) <= ATLAS_PADDING) maxLevel++;
+        TextureRender::UploadImage(page.data(), pageSize, pageSize, 4, TEXTURE_DOWNSCALE, maxLevel);
+        pages.push_back(textureID);
+        return textureID;
+    }
+
+    // Immagine sorgente RGBA già ridotta, condivisa tra l'atlas e il foglio della tilemap
+    struct SourceImage {
+        std::string filename;
+        std::vector<unsigned char> pixels;
+        int width, height;
+        bool opaque;
+    };
+
+    // Decodifica (una volta sola) le immagini da impacchettare. Le immagini mancanti
+    // vengono saltate (restano gestite da TextureRender).
+    // Con TEXTURE_DOWNSCALE ogni immagine viene ridotta a ATLAS_MAX_SPAN tile a schermo.
+    inline std::vector<SourceImage> DecodeSources(const std::vector<std::string>& filenames) {
+        std::vector<SourceImage> images;
+        for (const auto& filename : filenames) {
+            if (regions.count(filename)) continue;
+            int width, height, channels;
+            unsigned char* decoded = AssetPack::LoadPixels(filename, &width, &height, &channels, 4);
+            if (!decoded) continue;
+            bool opaque = IsOpaque(decoded, width, height, 4);
+            std::vector<unsigned char> pixels = TextureRender::FitImage(decoded, width, height, 4,
+                                                                        ATLAS_MAX_SPAN * TextureRender::TILE_PIXELS_X,
+                                                                        ATLAS_MAX_SPAN * TextureRender::TILE_PIXELS_Y);
+            stbi_image_free(decoded);
+            images.push_back(SourceImage{filename, std::move(pixels), width, height, opaque});
+        }
+        return images;
+    }
+
+    // Costruisce l'atlas con uno shelf packer: immagini ordinate per altezza,
+    // messe in righe da sinistra a destra, nuova pagina quando quella corrente è piena.
+    inline void Build(const std::vector<SourceImage>& sources) {
+        GLint maxSize = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+        const int pageSize = std::min<int>(ATLAS_PAGE_SIZE, maxSize > 0 ? maxSize : ATLAS_PAGE_SIZE);
+        const int pad = ATLAS_PADDING;
+
+        std::vector<const SourceImage*> images;
+        for (const SourceImage& img : sources) {
+            if (img.width + 2 * pad > pageSize || img.height + 2 * pad > pageSize) continue; // troppo grande per una pagina
+            images.push_back(&img);
+        }
+        if (images.empty()) return;
+
+        std::stable_sort(images.begin(), images.end(),
+                         [](const SourceImage* a, const SourceImage* b) { return a->height > b->height; });
+
+        std::vector<unsigned char> page(size_t(pageSize) * pageSize * 4, 0);
+        std::vector<std::pair<std::string, Region>> placed; // regioni della pagina corrente
+        int shelfX = 0, shelfY = 0, shelfH = 0;
+
+        auto flushPage = [&]() {
+            if (placed.empty()) return;
+            GLuint textureID = UploadPage(page, pageSize);
+            for (auto& p : placed) {
+                p.second.texture = textureID;
+                regions[p.first] = p.second;
+            }
+            placed.clear();
+            std::fill(page.begin(), page.end(), 0);
+            shelfX = shelfY = shelfH = 0;
+        };
+
+        for (const SourceImage* source : images) {
+            const SourceImage& img = *source;
+            int cellW = img.width + 2 * pad;
+            int cellH = img.height + 2 * pad;
+            if (shelfX + cellW > pageSize) { // riga piena: nuova riga
+                shelfY += shelfH;
+                shelfX = shelfH = 0;
+            }
+            if (shelfY + cellH > pageSize) flushPage(); // pagina piena
+
+            int px = shelfX + pad, py = shelfY + pad;
+            Blit(page, pageSize, img.pixels.data(), img.width, img.height, px, py);
+            placed.push_back({img.filename, Region{0,
+                                                   px / float(pageSize), py / float(pageSize),
+                                                   (px + img.width) / float(pageSize),
+                                                   (py + img.height) / float(pageSize),
+                                                   img.opaque}});
+            shelfX += cellW;
+            shelfH = std::max(shelfH, cellH);
+        }
+        flushPage();
+
+        std::cout << "Atlas: " << regions.size() << " texture in " << pages.size()
+                  << " pagine " << pageSize << "x" << pageSize << std::endl;
+    }
+
+    inline void Release() {
+        if (!pages.empty()) TextureRender::DeleteTextures(GLsizei(pages.size()), pages.data());
+        pages.clear();
+        regions.clear();
+    }
+
+} // namespace TextureAtlas
+
+#endif // TEXTURE_ATLAS_HPP
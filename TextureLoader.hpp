@@ -1,26 +1,57 @@
 #ifndef TEXTURE_LOADER_HPP
 #define TEXTURE_LOADER_HPP
 
-#include <GL/gl.h>
+#include <GL/glew.h> // prima di gl.h
 #include <GL/glu.h>
 #include <iostream>
 #include <unordered_map>
 #include <string>
 #include <map>
-#include <thread>
-#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
 // --- STB_IMAGE --- 
 #ifdef TEXTURE_LOADER_IMPLEMENTATION 
 #define STB_IMAGE_IMPLEMENTATION 
 #endif 
 #include "stb_image.h"
+#include "Variable.hpp"
+#include "GLState.hpp"
+#include "TextureResample.hpp"
+#include "TextureAtlas.hpp"
+#include "TextureStreaming.hpp"
 
 namespace TextureRender {
 
     // Cache delle texture già caricate: filename -> GLuint
     static std::unordered_map<std::string, GLuint> textureCache;
+    // Texture senza trasparenza (classificate al caricamento leggendo il canale alpha)
+    static std::unordered_map<GLuint, bool> opaqueTextures;
+    // Byte caricati (con le mipmap) per ogni texture singola; le pagine dell'atlas non ci sono
+    static std::unordered_map<GLuint, size_t> textureSizes;
+    // Dimensione massima a schermo in tile per path (registrata dai livelli; assente = sprite sheet,
+    // caricato a piena risoluzione e senza mipmap per non mescolare i frame)
+    struct Footprint { float tilesX = 0.0f, tilesY = 0.0f; };
+    static std::unordered_map<std::string, Footprint> textureFootprints;
+    // Footprint con cui è stata ridotta ogni texture di textureCache
+    static std::unordered_map<std::string, Footprint> loadedFootprints;
 
-    // Funzione per caricare una texture da file usando stb_image
+    // Restituisce true se il footprint è cresciuto
+    inline bool SetFootprint(const std::string& filename, float tilesX, float tilesY) {
+        Footprint& f = textureFootprints[filename];
+        if (tilesX <= f.tilesX && tilesY <= f.tilesY) return false;
+        f.tilesX = std::max(f.tilesX, tilesX);
+        f.tilesY = std::max(f.tilesY, tilesY);
+        return true;
+    }
+
+    inline Footprint GetFootprint(const std::string& filename) {
+        auto fp = textureFootprints.find(filename);
+        return fp != textureFootprints.end() ? fp->second : Footprint();
+    }
+
+    // Funzione per caricare una texture da file usando stb_image (sincrona, sul thread GL)
     inline GLuint LoadTextureFromFile(const std::string& filename) {
         // Controlla se è già in cache
         auto it = textureCache.find(filename);
@@ -29,56 +60,302 @@ namespace TextureRender {
             return it->second; // già caricata
         }
 
-        int width, height, channels;
-        unsigned char* image = stbi_load(filename.c_str(), &width, &height, &channels, 0);
-        if (!image) {
+        // riduzione alla dimensione a schermo + mipmap (solo per le texture con footprint noto)
+        Footprint fp = GetFootprint(filename);
+        DecodedImage image;
+        if (!DecodeImage(filename, fp.tilesX, fp.tilesY, image)) {
             std::cerr << "Errore caricamento immagine: " << filename << std::endl;
             return LoadTextureFromFile("texture/block/null.png"); //diamo una texture di default per quelle non trovate 
         }
 
-        GLuint textureID;
-        glGenTextures(1, &textureID);
-        glBindTexture(GL_TEXTURE_2D, textureID);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        GLenum format = (channels == 4) ? GL_RGBA : GL_RGB;
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, image);
-
-        stbi_image_free(image);
+        GLuint textureID = UploadDecoded(image, false);
+        opaqueTextures[textureID] = image.opaque;
+        textureSizes[textureID] = image.pixels.size();
 
         // Salva nella cache
         textureCache[filename] = textureID;
+        loadedFootprints[filename] = fp;
 
         return textureID;
     }
 
-    // Funzione principale: accetta filename, carica se serve e renderizza
-    inline void RenderTexture(const std::string& filename, float x0, float y0, float x1, float y1){
+    // Texture + rettangolo UV: dall'atlas se la path è stata impacchettata,
+    // altrimenti la texture singola con UV 0..1
+    inline TextureAtlas::Region GetRegion(const std::string& filename) {
+        TextureAtlas::Region region;
+        if (TEXTURE_ATLAS && TextureAtlas::Find(filename, region)) return region;
         GLuint texID = LoadTextureFromFile(filename);
-        if (texID == 0) return; // errore nel caricamento
+        return TextureAtlas::Region{texID, 0.0f, 0.0f, 1.0f, 1.0f, opaqueTextures[texID]};
+    }
 
-        glBindTexture(GL_TEXTURE_2D, texID);
+    // ---------- HANDLE ----------
+    // Al caricamento dei livelli ogni path viene convertita una sola volta in un indice
+    // della tabella delle texture; il rendering usa solo l'indice (niente hash di stringhe).
+    typedef uint32_t TextureHandle;
+    const TextureHandle INVALID_TEXTURE = 0xFFFFFFFFu;
+
+    enum TextureState : uint8_t {
+        TEXTURE_UNLOADED,   // solo registrata
+        TEXTURE_LOADING,    // in decodifica sui worker: si disegna il segnaposto
+        TEXTURE_RESIDENT    // region valida (texture GL caricata o trovata nell'atlas)
+    };
+
+    struct TextureEntry {
+        std::string filename;
+        TextureAtlas::Region region;
+        TextureState state = TEXTURE_UNLOADED;
+        bool reloading = false;     // residente, in decodifica a un footprint più grande
+    };
+
+    static std::vector<TextureEntry> textureTable;
+    static std::unordered_map<std::string, TextureHandle> textureHandles;
+
+    // Registra la path (senza toccare GL) e ne restituisce l'handle
+    inline TextureHandle RegisterTexture(const std::string& filename) {
+        auto it = textureHandles.find(filename);
+        if (it != textureHandles.end()) return it->second;
+
+        TextureHandle handle = TextureHandle(textureTable.size());
+        textureTable.push_back(TextureEntry{filename, TextureAtlas::Region{0, 0.0f, 0.0f, 1.0f, 1.0f}});
+        textureHandles[filename] = handle;
+        return handle;
+    }
+
+    // Incrementato a ogni texture che diventa residente (chi ha disegnato con il segnaposto
+    // in una cache sa così di doverla rifare)
+    static unsigned long textureGeneration = 0;
+
+    // Segnaposto 1x1 grigio semitrasparente per le texture ancora in decodifica
+    inline const TextureAtlas::Region& PlaceholderRegion() {
+        static TextureAtlas::Region placeholder{0, 0.0f, 0.0f, 1.0f, 1.0f, false};
+        if (!placeholder.texture) {
+            const unsigned char pixel[4] = {128, 128, 128, 96};
+            glGenTextures(1, &placeholder.texture);
+            BindTexture(placeholder.texture);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        }
+        return placeholder;
+    }
+
+    // Regione dell'handle, caricata in modo sincrono se non è ancora residente (per chi
+    // deve registrarla in un buffer statico, es. il TileLayer)
+    inline const TextureAtlas::Region& ResolveTexture(TextureHandle handle) {
+        TextureEntry& entry = textureTable[handle];
+        if (entry.state != TEXTURE_RESIDENT) {
+            entry.region = GetRegion(entry.filename);
+            entry.state = TEXTURE_RESIDENT; // l'eventuale decodifica in corso verrà scartata
+        }
+        return entry.region;
+    }
+
+    // Regione dell'handle: la texture viene caricata al primo uso. Con ASYNC_TEXTURES la
+    // decodifica parte sui worker e nel frattempo si restituisce il segnaposto.
+    inline const TextureAtlas::Region& GetRegion(TextureHandle handle) {
+        TextureEntry& entry = textureTable[handle];
+        if (entry.state == TEXTURE_RESIDENT) return entry.region;
+        if (entry.state == TEXTURE_UNLOADED) {
+            // atlas o texture già caricata: niente da decodificare
+            TextureAtlas::Region region;
+            bool ready = TEXTURE_ATLAS && TextureAtlas::Find(entry.filename, region);
+            if (ready || !ASYNC_TEXTURES || textureCache.count(entry.filename)) return ResolveTexture(handle);
+
+            Footprint fp = GetFootprint(entry.filename);
+            entry.state = TEXTURE_LOADING;
+            textureStreamer.request(handle, entry.filename, fp.tilesX, fp.tilesY);
+        }
+        return PlaceholderRegion();
+    }
+
+    // ---------- FOOTPRINT CRESCIUTO ----------
+    // Un livello caricato dopo può disegnare una texture già residente più grande della
+    // dimensione a cui è stata ridotta: la si ricarica, così il risultato non dipende
+    // dall'ordine dei livelli. La texture singola viene sostituita nello stesso id GL
+    // (TileLayer e cache che lo hanno registrato restano validi).
+    inline bool Outgrown(const std::string& filename) {
+        auto loaded = loadedFootprints.find(filename);
+        if (loaded == loadedFootprints.end()) return false;
+        if (loaded->second.tilesX <= 0.0f || loaded->second.tilesY <= 0.0f) return false; // piena risoluzione
+        Footprint fp = GetFootprint(filename);
+        return fp.tilesX > loaded->second.tilesX || fp.tilesY > loaded->second.tilesY;
+    }
+
+    inline void ReloadTexture(TextureHandle handle) {
+        TextureEntry& entry = textureTable[handle];
+        auto cached = textureCache.find(entry.filename);
+        if (entry.reloading || cached == textureCache.end()) return;
+        Footprint fp = GetFootprint(entry.filename);
+        if (ASYNC_TEXTURES) {
+            entry.reloading = true; // intanto si disegna quella ridotta
+            textureStreamer.request(handle, entry.filename, fp.tilesX, fp.tilesY);
+            return;
+        }
+        DecodedImage image;
+        if (!DecodeImage(entry.filename, fp.tilesX, fp.tilesY, image)) return;
+        UploadDecoded(image, false, cached->second);
+        textureSizes[cached->second] = image.pixels.size();
+        loadedFootprints[entry.filename] = fp;
+        textureGeneration++;
+    }
+
+    // Registra il footprint di un livello (thread GL). Le regioni dell'atlas sono ridotte a
+    // ATLAS_MAX_SPAN tile: oltre quella misura la path esce dall'atlas e si carica come
+    // texture singola alla dimensione giusta.
+    inline void GrowFootprint(const std::string& filename, float tilesX, float tilesY) {
+        if (!SetFootprint(filename, tilesX, tilesY)) return;
+        auto it = textureHandles.find(filename);
+        if (it == textureHandles.end()) return; // non ancora caricata
+        TextureEntry& entry = textureTable[it->second];
+        Footprint fp = GetFootprint(filename);
+        if (TEXTURE_ATLAS && (fp.tilesX > ATLAS_MAX_SPAN || fp.tilesY > ATLAS_MAX_SPAN) && TextureAtlas::Remove(filename)) {
+            if (entry.state == TEXTURE_RESIDENT) {
+                entry.region = TextureAtlas::Region{0, 0.0f, 0.0f, 1.0f, 1.0f};
+                entry.state = TEXTURE_UNLOADED;
+                textureGeneration++;
+            }
+            return;
+        }
+        if (entry.state == TEXTURE_RESIDENT && Outgrown(filename)) ReloadTexture(it->second);
+    }
+
+    // Thread GL, una volta per frame: carica le texture decodificate entro budgetSeconds.
+    // Restituisce quante texture sono diventate residenti (l'immagine a schermo va rifatta).
+    inline int PumpTextureUploads(double budgetSeconds) {
+        return textureStreamer.pump(budgetSeconds, [](DecodedImage& img) {
+            TextureEntry& entry = textureTable[img.handle];
+            auto cached = textureCache.find(img.filename);
+            if (entry.reloading) {
+                entry.reloading = false;
+                if (cached != textureCache.end() && img.ok) {
+                    UploadDecoded(img, PboSupported(), cached->second);
+                    opaqueTextures[cached->second] = img.opaque;
+                    textureSizes[cached->second] = img.pixels.size();
+                    loadedFootprints[img.filename] = Footprint{img.tilesX, img.tilesY};
+                    textureGeneration++;
+                }
+                if (Outgrown(img.filename)) ReloadTexture(img.handle); // cresciuto ancora
+                return;
+            }
+            // già risolta in modo sincrono, o scaricata durante la decodifica (nessun riferimento)
+            if (entry.state != TEXTURE_LOADING) return;
+            GLuint textureID = 0;
+            if (cached != textureCache.end()) {
+                textureID = cached->second;
+            } else if (img.ok) {
+                textureID = UploadDecoded(img, PboSupported());
+                opaqueTextures[textureID] = img.opaque;
+                textureSizes[textureID] = img.pixels.size();
+                textureCache[img.filename] = textureID;
+                loadedFootprints[img.filename] = Footprint{img.tilesX, img.tilesY};
+            }
+            entry.region = TextureAtlas::Region{textureID, 0.0f, 0.0f, 1.0f, 1.0f, textureID && opaqueTextures[textureID]};
+            entry.state = TEXTURE_RESIDENT;
+            textureGeneration++;
+            if (Outgrown(img.filename)) ReloadTexture(img.handle); // footprint cresciuto durante la decodifica
+        });
+    }
+
+    // Texture decodificate che aspettano l'upload (le decodifiche in corso svegliano il
+    // loop da sole con onDecoded)
+    inline bool TextureUploadsPending() {
+        return textureStreamer.hasReady();
+    }
+
+    // ---------- RIFERIMENTI DEI LIVELLI ----------
+    // Ogni livello residente tiene un riferimento alle texture che usa; quando l'ultimo
+    // livello che la usa viene scaricato la texture GL viene liberata (thread GL).
+    // Le regioni dell'atlas restano: la pagina è condivisa.
+    static std::vector<uint32_t> textureRefs; // per handle
+
+    inline void RetainTexture(TextureHandle handle) {
+        if (handle == INVALID_TEXTURE) return;
+        if (textureRefs.size() < textureTable.size()) textureRefs.resize(textureTable.size(), 0);
+        textureRefs[handle]++;
+    }
+
+    inline void UnloadTexture(TextureHandle handle) {
+        TextureEntry& entry = textureTable[handle];
+        if (entry.state == TEXTURE_LOADING) {
+            entry.state = TEXTURE_UNLOADED; // la decodifica in corso verrà scartata da PumpTextureUploads
+            return;
+        }
+        if (entry.state != TEXTURE_RESIDENT) return;
+        TextureAtlas::Region region;
+        if (TEXTURE_ATLAS && TextureAtlas::Find(entry.filename, region)) return;
+        auto cached = textureCache.find(entry.filename);
+        if (cached != textureCache.end()) {
+            GLuint textureID = cached->second;
+            opaqueTextures.erase(textureID);
+            textureSizes.erase(textureID);
+            loadedFootprints.erase(entry.filename);
+            textureCache.erase(cached);
+            if (textureID) DeleteTextures(1, &textureID);
+        }
+        entry.region = TextureAtlas::Region{0, 0.0f, 0.0f, 1.0f, 1.0f};
+        entry.state = TEXTURE_UNLOADED;
+        entry.reloading = false;
+    }
+
+    // Byte GPU della texture se è residente come texture singola (0 per atlas e segnaposto)
+    inline size_t TextureBytes(TextureHandle handle) {
+        const TextureEntry& entry = textureTable[handle];
+        if (entry.state != TEXTURE_RESIDENT) return 0;
+        auto it = textureSizes.find(entry.region.texture);
+        return it != textureSizes.end() ? it->second : 0;
+    }
+
+    // Livelli che trattengono la texture
+    inline uint32_t TextureRefCount(TextureHandle handle) {
+        return handle < textureRefs.size() ? textureRefs[handle] : 0;
+    }
+
+    inline void ReleaseTexture(TextureHandle handle) {
+        if (handle == INVALID_TEXTURE || handle >= textureRefs.size() || textureRefs[handle] == 0) return;
+        if (--textureRefs[handle] == 0) UnloadTexture(handle);
+    }
+
+    // Prima di distruggere il contesto GL: ferma i worker e libera il PBO
+    inline void StopTextureStreaming() {
+        textureStreamer.shutdown();
+        if (uploadPbo) glDeleteBuffers(1, &uploadPbo);
+        uploadPbo = 0;
+    }
+
+    inline void RenderRegion(const TextureAtlas::Region& r, float x0, float y0, float x1, float y1) {
+        if (r.texture == 0) return; // errore nel caricamento
+
+        BindTexture(r.texture);
+        SetEnabled(GL_BLEND, !r.opaque);
 
         glBegin(GL_QUADS);
-            glTexCoord2f(0.0f, 1.0f); glVertex2f(x0, y0);
-            glTexCoord2f(1.0f, 1.0f); glVertex2f(x1, y0);
-            glTexCoord2f(1.0f, 0.0f); glVertex2f(x1, y1);
-            glTexCoord2f(0.0f, 0.0f); glVertex2f(x0, y1);
+            glTexCoord2f(r.u0, r.v1); glVertex2f(x0, y0);
+            glTexCoord2f(r.u1, r.v1); glVertex2f(x1, y0);
+            glTexCoord2f(r.u1, r.v0); glVertex2f(x1, y1);
+            glTexCoord2f(r.u0, r.v0); glVertex2f(x0, y1);
         glEnd();
+        Enable(GL_BLEND);
     }
 
-     // Effetto di transizione nera (fade)
+    inline void RenderTexture(TextureHandle handle, float x0, float y0, float x1, float y1) {
+        RenderRegion(GetRegion(handle), x0, y0, x1, y1);
+    }
+
+    // Versione con path (per tool e debug): fa l'hash della stringa a ogni chiamata
+    inline void RenderTexture(const std::string& filename, float x0, float y0, float x1, float y1) {
+        RenderRegion(GetRegion(filename), x0, y0, x1, y1);
+    }
+
+    // Effetto di transizione nera (fade): disegna solo il velo, la durata la gestisce Transition
     inline void RenderBlackTransition(float alpha, float x0, float y0, float x1, float y1) {
         if (alpha <= 0.0f) return; // nessun effetto
         if (alpha > 1.0f) alpha = 1.0f;
 
         // Abilita blending per la trasparenza
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
         // Disabilita texture per disegnare solo il quadrato nero
-        glDisable(GL_TEXTURE_2D);
+        Disable(GL_TEXTURE_2D);
             
         
         glColor4f(0.0f, 0.0f, 0.0f, alpha);
@@ -91,15 +368,8 @@ namespace TextureRender {
         glEnd();
 
         // Ripristina lo stato
-        glEnable(GL_TEXTURE_2D);
+        Enable(GL_TEXTURE_2D);
         glColor4f(1.0f, 1.0f, 1.0f, 1.0f); // reset colore
-         // Tempo di inizio
-        auto start = std::chrono::steady_clock::now();
-
-        // Loop finché non è passato 1 secondo
-        while (std::chrono::duration_cast<std::chrono::seconds>(
-                std::chrono::steady_clock::now() - start).count() < 0.2f) {
-        }
     }
 
 } // namespace TextureRender
@@ -425,4 +695,17 @@ static std::map<int, std::string> tileTextures = {
     {316, "texture/decoration/furniture_pack/floors and walls/individual sprites/Slice 156.png"},
     {317, "texture/block/grass.png"}
 };
+
+// Impacchetta nell'atlas tutte le texture della tabella (da chiamare dopo glewInit)
+// Le immagini dei tile si decodificano una volta sola: finiscono nell'atlas e, se serve
+// (sources), nel foglio condiviso della tilemap
+inline void BuildTileAtlas(const std::function<void(const std::vector<TextureAtlas::SourceImage>&)>& sources = nullptr) {
+    if (!TEXTURE_ATLAS && !sources) return;
+    std::vector<std::string> filenames;
+    filenames.reserve(tileTextures.size());
+    for (const auto& t : tileTextures) filenames.push_back(t.second);
+    std::vector<TextureAtlas::SourceImage> images = TextureAtlas::DecodeSources(filenames);
+    if (TEXTURE_ATLAS) TextureAtlas::Build(images);
+    if (sources) sources(images);
+}
 #endif // TEXTURE_LOADER_HPP
\ No newline at end of file
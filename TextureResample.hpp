@@ -0,0 +1,84 @@
+#ifndef TEXTURE_RESAMPLE_HPP
+#define TEXTURE_RESAMPLE_HPP
+
+#include <GL/glew.h>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include "Variable.hpp"
+#include "GLState.hpp"
+
+// ---------- TEXTURE RESAMPLE ----------
+// Riduzione delle texture alla dimensione con cui appaiono a schermo e catena di mipmap.
+// Un tile 256x256 a 800x600 con griglia 16x16 occupa circa 50x37 pixel: caricarlo a
+// piena risoluzione spreca VRAM e banda senza migliorare l'immagine.
+namespace TextureRender {
+
+    // Pixel a schermo di un tile con la risoluzione e la griglia correnti
+    constexpr int TILE_PIXELS_X = WIDTH / GRID_SIZE;
+    constexpr int TILE_PIXELS_Y = HEIGHT / GRID_SIZE;
+
+    // Dimezza l'immagine con media 2x2 (se un lato è dispari l'ultima riga/colonna viene replicata)
+    inline std::vector<unsigned char> HalveImage(const unsigned char* src, int w, int h, int channels,
+                                                 int& outW, int& outH) {
+        outW = std::max(1, w / 2);
+        outH = std::max(1, h / 2);
+        std::vector<unsigned char> dst(size_t(outW) * outH * channels);
+        for (int y = 0; y < outH; y++) {
+            int y0 = std::min(y * 2, h - 1), y1 = std::min(y * 2 + 1, h - 1);
+            for (int x = 0; x < outW; x++) {
+                int x0 = std::min(x * 2, w - 1), x1 = std::min(x * 2 + 1, w - 1);
+                for (int k = 0; k < channels; k++) {
+                    unsigned sum = src[(y0 * w + x0) * channels + k] + src[(y0 * w + x1) * channels + k]
+                                 + src[(y1 * w + x0) * channels + k] + src[(y1 * w + x1) * channels + k];
+                    dst[(size_t(y) * outW + x) * channels + k] = (unsigned char)((sum + 2) / 4);
+                }
+            }
+        }
+        return dst;
+    }
+
+    // Dimezza finché l'immagine resta grande almeno quanto il target in pixel.
+    // target <= 0 = nessuna riduzione. w/h vengono aggiornati.
+    inline std::vector<unsigned char> FitImage(const unsigned char* src, int& w, int& h, int channels,
+                                               int targetW, int targetH) {
+        std::vector<unsigned char> image(src, src + size_t(w) * h * channels);
+        if (!TEXTURE_DOWNSCALE || targetW <= 0 || targetH <= 0) return image;
+        while (w / 2 >= targetW && h / 2 >= targetH) {
+            int nw, nh;
+            image = HalveImage(image.data(), w, h, channels, nw, nh);
+            w = nw;
+            h = nh;
+        }
+        return image;
+    }
+
+    // Carica la texture legata con la catena di mipmap completa (maxLevel < 0) o fino a maxLevel.
+    // Senza mipmap resta il filtro GL_LINEAR come prima.
+    inline void UploadImage(const unsigned char* pixels, int w, int h, int channels,
+                            bool mipmaps, int maxLevel = -1) {
+        GLenum format = (channels == 4) ? GL_RGBA : GL_RGB;
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // righe RGB non allineate a 4 byte
+        glTexImage2D(GL_TEXTURE_2D, 0, format, w, h, 0, format, GL_UNSIGNED_BYTE, pixels);
+
+        int level = 0;
+        if (mipmaps) {
+            std::vector<unsigned char> current(pixels, pixels + size_t(w) * h * channels);
+            while ((w > 1 || h > 1) && (maxLevel < 0 || level < maxLevel)) {
+                int nw, nh;
+                current = HalveImage(current.data(), w, h, channels, nw, nh);
+                w = nw;
+                h = nh;
+                glTexImage2D(GL_TEXTURE_2D, ++level, format, w, h, 0, format, GL_UNSIGNED_BYTE, current.data());
+            }
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+
+} // namespace TextureRender
+
+#endif // TEXTURE_RESAMPLE_HPP
@@ -0,0 +1,202 @@
+#ifndef TEXTURE_STREAMING_HPP
+#define TEXTURE_STREAMING_HPP
+
+#include <GL/glew.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include "Variable.hpp"
+#include "GLState.hpp"
+#include "TextureResample.hpp"
+#include "TextureAtlas.hpp"
+#include "ThreadPool.hpp"
+#include "AssetPack.hpp"
+// stb_image viene incluso da TextureLoader.hpp (che contiene anche l'implementazione)
+
+// ---------- TEXTURE STREAMING ----------
+// Decodifica delle immagini fuori dal thread GL: i worker fanno stbi_load (dal pacchetto
+// asset o dal file), riduzione e catena di mipmap; il thread GL riceve i pixel pronti e li
+// carica attraverso un pixel buffer object, entro un budget di tempo per frame. Finché la
+// texture non è residente si disegna un segnaposto.
+namespace TextureRender {
+
+    // Immagine decodificata con tutti i livelli di mipmap in un unico buffer
+    struct DecodedImage {
+        struct Level { int width, height; size_t offset; };
+
+        uint32_t handle = 0;        // TextureHandle di chi l'ha richiesta
+        std::string filename;
+        std::vector<unsigned char> pixels;
+        std::vector<Level> levels;  // [0] = immagine piena
+        float tilesX = 0.0f, tilesY = 0.0f; // footprint usato per la riduzione
+        int channels = 4;
+        bool opaque = false;
+        bool mipmaps = false;
+        bool ok = false;
+    };
+
+    // Solo CPU (nessuna chiamata GL): sicura da chiamare da qualsiasi thread.
+    // tilesX/tilesY > 0: l'immagine viene ridotta alla dimensione a schermo e riceve le mipmap.
+    inline bool DecodeImage(const std::string& filename, float tilesX, float tilesY, DecodedImage& out) {
+        int width, height, channels;
+        unsigned char* image = AssetPack::LoadPixels(filename, &width, &height, &channels, 0);
+        if (!image) return false;
+
+        out.filename = filename;
+        out.tilesX = tilesX;
+        out.tilesY = tilesY;
+        out.channels = channels;
+        out.opaque = TextureAtlas::IsOpaque(image, width, height, channels);
+        out.levels.clear();
+        out.pixels.clear();
+
+        bool scaled = tilesX > 0.0f && tilesY > 0.0f;
+        std::vector<unsigned char> current;
+        if (scaled) {
+            current = FitImage(image, width, height, channels,
+                               int(tilesX * TILE_PIXELS_X + 0.5f), int(tilesY * TILE_PIXELS_Y + 0.5f));
+        } else {
+            current.assign(image, image + size_t(width) * height * channels);
+        }
+        stbi_image_free(image);
+
+        out.mipmaps = scaled && TEXTURE_DOWNSCALE;
+        for (;;) {
+            out.levels.push_back(DecodedImage::Level{width, height, out.pixels.size()});
+            out.pixels.insert(out.pixels.end(), current.begin(), current.end());
+            if (!out.mipmaps || (width == 1 && height == 1)) break;
+            int nw, nh;
+            current = HalveImage(current.data(), width, height, channels, nw, nh);
+            width = nw;
+            height = nh;
+        }
+        out.ok = true;
+        return true;
+    }
+
+    static GLuint uploadPbo = 0; // PBO condiviso dagli upload (riallocato a ogni uso)
+
+    // Carica i livelli in una nuova texture GL (o li sostituisce in textureID). Con usePbo
+    // i pixel passano da un pixel buffer object (orphaning a ogni upload): la copia verso
+    // la GPU è asincrona.
+    inline GLuint UploadDecoded(const DecodedImage& img, bool usePbo, GLuint textureID = 0) {
+        const unsigned char* base = img.pixels.data();
+        if (usePbo) {
+            if (!uploadPbo) glGenBuffers(1, &uploadPbo);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadPbo);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, img.pixels.size(), nullptr, GL_STREAM_DRAW);
+            void* mapped = glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+            if (mapped) {
+                std::memcpy(mapped, img.pixels.data(), img.pixels.size());
+                glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+                base = nullptr; // da qui gli indirizzi sono offset nel PBO
+            } else {
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                usePbo = false;
+            }
+        }
+
+        if (!textureID) glGenTextures(1, &textureID);
+        BindTexture(textureID);
+        GLenum format = (img.channels == 4) ? GL_RGBA : GL_RGB;
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // righe RGB non allineate a 4 byte
+        for (size_t i = 0; i < img.levels.size(); i++) {
+            const DecodedImage::Level& l = img.levels[i];
+            glTexImage2D(GL_TEXTURE_2D, GLint(i), format, l.width, l.height, 0, format, GL_UNSIGNED_BYTE,
+                         base + l.offset);
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        if (usePbo) glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, GLint(img.levels.size()) - 1);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, img.mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        return textureID;
+    }
+
+    inline bool PboSupported() {
+        return GLEW_VERSION_2_1 || GLEW_ARB_pixel_buffer_object;
+    }
+
+    // ---------- STREAMER ----------
+    // request() dal thread GL mette in coda la decodifica; i worker depositano il
+    // risultato in una coda protetta da mutex che pump() svuota entro il budget.
+    class TextureStreamer {
+    public:
+        std::function<void()> onDecoded; // chiamata dal worker (es. glfwPostEmptyEvent)
+
+        void request(uint32_t handle, const std::string& filename, float tilesX, float tilesY) {
+            if (!pool) pool.reset(new ThreadPool(TEXTURE_DECODE_THREADS));
+            pool->submit([this, handle, filename, tilesX, tilesY]() {
+                DecodedImage img;
+                if (!cancelled) {
+                    if (!DecodeImage(filename, tilesX, tilesY, img)) {
+                        std::cerr << "Errore caricamento immagine: " << filename << std::endl;
+                        DecodeImage("texture/block/null.png", 0.0f, 0.0f, img); // texture di default
+                        img.filename = filename;
+                    }
+                }
+                img.handle = handle;
+                {
+                    std::lock_guard<std::mutex> lock(readyMutex);
+                    ready.push_back(std::move(img));
+                }
+                if (onDecoded && !cancelled) onDecoded();
+            });
+        }
+
+        // Immagini decodificate in attesa di upload
+        bool hasReady() const {
+            std::lock_guard<std::mutex> lock(readyMutex);
+            return !ready.empty();
+        }
+
+        // Thread GL: passa a upload() le immagini pronte finché resta budget (almeno una
+        // per frame, così si avanza anche con budget minimo). Restituisce quante ne ha passate.
+        template <typename UploadFn>
+        int pump(double budgetSeconds, UploadFn upload) {
+            typedef std::chrono::steady_clock Clock;
+            const Clock::time_point start = Clock::now();
+            int count = 0;
+            for (;;) {
+                DecodedImage img;
+                {
+                    std::lock_guard<std::mutex> lock(readyMutex);
+                    if (ready.empty()) break;
+                    img = std::move(ready.front());
+                    ready.pop_front();
+                }
+                upload(img);
+                count++;
+                if (std::chrono::duration<double>(Clock::now() - start).count() >= budgetSeconds) break;
+            }
+            return count;
+        }
+
+        // Ferma i worker (le decodifiche non ancora iniziate vengono saltate)
+        void shutdown() {
+            cancelled = true;
+            pool.reset();
+            std::lock_guard<std::mutex> lock(readyMutex);
+            ready.clear();
+        }
+
+    private:
+        std::unique_ptr<ThreadPool> pool; // creato alla prima richiesta
+        mutable std::mutex readyMutex;
+        std::deque<DecodedImage> ready;
+        std::atomic<bool> cancelled{false};
+    };
+
+    static TextureStreamer textureStreamer;
+
+} // namespace TextureRender
+
+#endif // TEXTURE_STREAMING_HPP
@@ -0,0 +1,87 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+
+// ---------- THREAD POOL ----------
+// Pool di worker con una coda FIFO di lavori. Serve per il lavoro da CPU che non
+// tocca GL (decodifica delle immagini, parsing): i risultati tornano al thread GL
+// attraverso code proprie di chi sottomette il lavoro.
+class ThreadPool {
+public:
+    typedef std::function<void()> Job;
+
+    // threads = 0: un worker per core, lasciandone uno al thread principale
+    explicit ThreadPool(unsigned threads = 0) {
+        if (threads == 0) {
+            unsigned cores = std::thread::hardware_concurrency(); // 0 se non si sa
+            threads = cores > 1 ? cores - 1 : 1;
+        }
+        workers.reserve(threads);
+        for (unsigned i = 0; i < threads; i++) workers.emplace_back([this]() { work(); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& t : workers) t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(Job job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(std::move(job));
+        }
+        wake.notify_one();
+    }
+
+    // Blocca finché la coda è vuota e nessun worker sta lavorando
+    void waitIdle() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this]() { return jobs.empty() && busy == 0; });
+    }
+
+    size_t size() const { return workers.size(); }
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<Job> jobs;
+    std::mutex mutex;
+    std::condition_variable wake, idle;
+    unsigned busy = 0;
+    bool stopping = false;
+
+    void work() {
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]() { return stopping || !jobs.empty(); });
+                if (jobs.empty()) return; // stopping e niente da fare
+                job = std::move(jobs.front());
+                jobs.pop_front();
+                busy++;
+            }
+            job();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                busy--;
+                if (jobs.empty() && busy == 0) idle.notify_all();
+            }
+        }
+    }
+};
+
+#endif // THREAD_POOL_HPP
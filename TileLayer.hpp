@@ -0,0 +1,111 @@
+#ifndef TILE_LAYER_HPP
+#define TILE_LAYER_HPP
+
+#include <GL/glew.h>
+#include "GLState.hpp"
+#include <vector>
+#include <algorithm>
+
+// ---------- TILE LAYER ----------
+// Geometria statica del background: tutti i quad del livello vengono messi in un
+// unico vertex buffer al caricamento, raggruppati per texture. Il disegno costa
+// quindi un glDrawArrays per texture invece di un glBegin/glEnd per tile.
+// I batch opachi vengono prima e senza blending; i tile non si sovrappongono,
+// quindi l'ordine tra batch non cambia l'immagine.
+struct TileLayer {
+    struct Quad {
+        GLuint texture;
+        bool opaque;
+        float x0, y0, x1, y1;
+        float u0, v0, u1, v1;
+    };
+    struct Batch {
+        GLuint texture;
+        bool opaque;
+        GLint first;    // primo vertice nel buffer
+        GLsizei count;  // numero di vertici (4 per quad)
+    };
+
+    GLuint vbo = 0;
+    std::vector<Quad> pending;      // quad raccolti prima di build()
+    std::vector<float> vertices;    // x, y, u, v (tenuti solo se manca il supporto VBO)
+    std::vector<Batch> batches;
+
+    void addQuad(GLuint texture, bool opaque, float x0, float y0, float x1, float y1,
+                 float u0 = 0.0f, float v0 = 0.0f, float u1 = 1.0f, float v1 = 1.0f) {
+        pending.push_back(Quad{texture, opaque, x0, y0, x1, y1, u0, v0, u1, v1});
+    }
+
+    // Ordina i quad (prima gli opachi, poi per texture) e li carica sulla GPU
+    void build() {
+        release();
+        std::stable_sort(pending.begin(), pending.end(),
+                         [](const Quad& a, const Quad& b) {
+                             if (a.opaque != b.opaque) return a.opaque;
+                             return a.texture < b.texture;
+                         });
+
+        vertices.clear();
+        vertices.reserve(pending.size() * 16);
+        for (const Quad& q : pending) {
+            if (batches.empty() || batches.back().texture != q.texture || batches.back().opaque != q.opaque) {
+                batches.push_back(Batch{q.texture, q.opaque, GLint(vertices.size() / 4), 0});
+            }
+            // stesso ordine dei vertici di TextureRender::RenderTexture
+            const float quad[16] = {
+                q.x0, q.y0, q.u0, q.v1,
+                q.x1, q.y0, q.u1, q.v1,
+                q.x1, q.y1, q.u1, q.v0,
+                q.x0, q.y1, q.u0, q.v0
+            };
+            vertices.insert(vertices.end(), quad, quad + 16);
+            batches.back().count += 4;
+        }
+        pending.clear();
+
+        // VBO se disponibile (GL 1.5+), altrimenti vertex array lato client
+        if (GLEW_VERSION_1_5 && !vertices.empty()) {
+            glGenBuffers(1, &vbo);
+            glBindBuffer(GL_ARRAY_BUFFER, vbo);
+            glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            vertices.clear();
+            vertices.shrink_to_fit();
+        }
+    }
+
+    void draw() const {
+        if (batches.empty()) return;
+
+        const GLsizei stride = 4 * sizeof(float);
+        // con il VBO i puntatori sono offset nel buffer
+        const GLvoid* posPtr = vbo ? (const GLvoid*)0 : (const GLvoid*)vertices.data();
+        const GLvoid* uvPtr  = vbo ? (const GLvoid*)(2 * sizeof(float)) : (const GLvoid*)(vertices.data() + 2);
+        if (vbo) glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glVertexPointer(2, GL_FLOAT, stride, posPtr);
+        glTexCoordPointer(2, GL_FLOAT, stride, uvPtr);
+
+        for (const Batch& b : batches) {
+            TextureRender::SetEnabled(GL_BLEND, !b.opaque);
+            TextureRender::BindTexture(b.texture);
+            glDrawArrays(GL_QUADS, b.first, b.count);
+        }
+        TextureRender::Enable(GL_BLEND);
+
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
+        if (vbo) glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void release() {
+        if (vbo) glDeleteBuffers(1, &vbo);
+        vbo = 0;
+        vertices.clear();
+        batches.clear();
+    }
+};
+
+#endif // TILE_LAYER_HPP
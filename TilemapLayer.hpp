@@ -0,0 +1,223 @@
+#ifndef TILEMAP_LAYER_HPP
+#define TILEMAP_LAYER_HPP
+
+#include <GL/glew.h>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include "Variable.hpp"
+#include "Shader.hpp"
+#include "TextureLoader.hpp"
+#include "AssetPack.hpp"
+
+// ---------- TILEMAP LAYER ----------
+// Background disegnato da uno shader con un solo quad a schermo intero: gli id dei tile
+// sono in una piccola texture indice (una cella per tile) e il fragment shader legge
+// la cella corrispondente da un foglio con tutte le texture dei tile.
+// Il foglio è uno solo, costruito all'avvio (BuildSheet) dalle stesse immagini già
+// decodificate per l'atlas: entrare in un livello crea solo la texture indice.
+// Il costo non dipende dalla dimensione della griglia. Senza GLSL si usa TileLayer.
+struct TilemapLayer {
+    GLuint indexTexture = 0;  // RG = colonna/riga della cella nel foglio
+    int mapWidth = 0, mapHeight = 0;
+    bool opaque = false;      // tutte le celle usate opache: niente blending
+
+    bool ready() const { return indexTexture != 0; }
+
+    static bool Supported() {
+        return TILEMAP_SHADER && Shader::Available();
+    }
+
+    // Foglio condiviso: una cella TILEMAP_CELL_SIZE x TILEMAP_CELL_SIZE per texture.
+    // images: sorgenti dei tile (TextureAtlas::DecodeSources). Da chiamare dopo glewInit.
+    static bool BuildSheet(const std::vector<TextureAtlas::SourceImage>& images) {
+        ReleaseSheet();
+        if (!Supported() || !program()) return false;
+
+        Sheet& s = sheet();
+        GLint maxSize = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+        const int cell = TILEMAP_CELL_SIZE;
+        const int count = int(images.size()) + 1; // + cella di default
+        int perRow = 1;
+        while (perRow * perRow < count) perRow++;
+        if (perRow > 255 || perRow * cell > maxSize) return false; // troppe texture distinte
+
+        const int sheetSize = perRow * cell;
+        std::vector<unsigned char> pixels(size_t(sheetSize) * sheetSize * 4, 0);
+        auto place = [&](const unsigned char* image, int w, int h, bool opaque) {
+            int c = int(s.opaqueCells.size());
+            FillCell(pixels, sheetSize, (c % perRow) * cell, (c / perRow) * cell, image, w, h);
+            s.opaqueCells.push_back(opaque);
+            return c;
+        };
+
+        // cella 0: texture di default, per i tile senza una cella propria
+        int w, h, channels;
+        unsigned char* fallback = AssetPack::LoadPixels("texture/block/null.png", &w, &h, &channels, 4);
+        if (fallback) {
+            place(fallback, w, h, TextureAtlas::IsOpaque(fallback, w, h, 4));
+            stbi_image_free(fallback);
+        } else {
+            s.opaqueCells.push_back(false); // cella trasparente
+        }
+        for (const TextureAtlas::SourceImage& img : images) {
+            s.cells[img.filename] = place(img.pixels.data(), img.width, img.height, img.opaque);
+        }
+
+        s.texture = Upload(pixels.data(), sheetSize, sheetSize, GL_LINEAR);
+        s.cellsPerRow = perRow;
+        return true;
+    }
+
+    static void ReleaseSheet() {
+        Sheet& s = sheet();
+        if (s.texture) TextureRender::DeleteTextures(1, &s.texture);
+        s = Sheet();
+    }
+
+    // tiles: texture di ogni tile, riga per riga (y = 0 in basso).
+    // false se manca il foglio: il livello usa TileLayer.
+    bool build(int width, int height, const std::vector<TextureRender::TextureHandle>& tiles) {
+        release();
+        const Sheet& s = sheet();
+        if (!s.texture) return false;
+
+        std::vector<unsigned char> index(size_t(width) * height * 4, 0);
+        bool allOpaque = true;
+        for (int i = 0; i < width * height; i++) {
+            int c = 0;
+            if (tiles[i] != TextureRender::INVALID_TEXTURE) {
+                auto it = s.cells.find(TextureRender::textureTable[tiles[i]].filename);
+                if (it != s.cells.end()) c = it->second;
+            }
+            index[i * 4 + 0] = (unsigned char)(c % s.cellsPerRow);
+            index[i * 4 + 1] = (unsigned char)(c / s.cellsPerRow);
+            allOpaque &= s.opaqueCells[c];
+        }
+
+        indexTexture = Upload(index.data(), width, height, GL_NEAREST);
+        mapWidth = width;
+        mapHeight = height;
+        opaque = allOpaque;
+        return true;
+    }
+
+    void draw() const {
+        if (!ready()) return;
+        GLuint prog = program();
+        glUseProgram(prog);
+        glUniform1i(glGetUniformLocation(prog, "u_sheet"), 0);
+        glUniform1i(glGetUniformLocation(prog, "u_index"), 1);
+        glUniform2f(glGetUniformLocation(prog, "u_mapSize"), float(mapWidth), float(mapHeight));
+        glUniform1f(glGetUniformLocation(prog, "u_cellsPerRow"), float(sheet().cellsPerRow));
+        glUniform1f(glGetUniformLocation(prog, "u_halfTexel"), 0.5f / TILEMAP_CELL_SIZE);
+
+        // la cache traccia solo l'unità 0: l'unità 1 viene legata direttamente
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, indexTexture);
+        glActiveTexture(GL_TEXTURE0);
+        TextureRender::BindTexture(sheet().texture);
+
+        TextureRender::SetEnabled(GL_BLEND, !opaque);
+        glBegin(GL_QUADS);
+            glTexCoord2f(0.0f, 0.0f); glVertex2f(-1.0f, -1.0f);
+            glTexCoord2f(1.0f, 0.0f); glVertex2f( 1.0f, -1.0f);
+            glTexCoord2f(1.0f, 1.0f); glVertex2f( 1.0f,  1.0f);
+            glTexCoord2f(0.0f, 1.0f); glVertex2f(-1.0f,  1.0f);
+        glEnd();
+        TextureRender::Enable(GL_BLEND);
+
+        glUseProgram(0);
+    }
+
+    void release() {
+        if (indexTexture) TextureRender::DeleteTextures(1, &indexTexture);
+        indexTexture = 0;
+    }
+
+private:
+    struct Sheet {
+        GLuint texture = 0;
+        int cellsPerRow = 0;
+        std::map<std::string, int> cells;  // path della texture -> cella
+        std::vector<bool> opaqueCells;
+    };
+
+    static Sheet& sheet() {
+        static Sheet s;
+        return s;
+    }
+
+    // Programma condiviso da tutti i livelli (0 se lo shader non compila)
+    static GLuint program() {
+        static bool compiled = false;
+        static GLuint prog = 0;
+        if (compiled) return prog;
+        compiled = true;
+
+        const char* vertexSource = R"(
+            #version 120
+            varying vec2 v_uv;
+            void main() {
+                gl_Position = gl_Vertex;
+                v_uv = gl_MultiTexCoord0.xy;
+            }
+        )";
+        // local.y invertita: nelle immagini la prima riga è in alto
+        const char* fragmentSource = R"(
+            #version 120
+            uniform sampler2D u_sheet;
+            uniform sampler2D u_index;
+            uniform vec2 u_mapSize;
+            uniform float u_cellsPerRow;
+            uniform float u_halfTexel;
+            varying vec2 v_uv;
+            void main() {
+                vec2 tile = v_uv * u_mapSize;
+                vec2 cell = floor(texture2D(u_index, (floor(tile) + 0.5) / u_mapSize).rg * 255.0 + 0.5);
+                vec2 local = fract(tile);
+                local.y = 1.0 - local.y;
+                local = clamp(local, u_halfTexel, 1.0 - u_halfTexel);
+                gl_FragColor = texture2D(u_sheet, (cell + local) / u_cellsPerRow);
+            }
+        )";
+        prog = Shader::Link(vertexSource, fragmentSource);
+        return prog;
+    }
+
+    static GLuint Upload(const unsigned char* pixels, int w, int h, GLint filter) {
+        GLuint textureID;
+        glGenTextures(1, &textureID);
+        TextureRender::BindTexture(textureID);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        return textureID;
+    }
+
+    // Ricampiona l'immagine RGBA (media per area) dentro la cella
+    static void FillCell(std::vector<unsigned char>& sheet, int sheetSize, int ox, int oy,
+                         const unsigned char* image, int w, int h) {
+        const int cell = TILEMAP_CELL_SIZE;
+        for (int y = 0; y < cell; y++) {
+            int sy0 = y * h / cell, sy1 = std::max(sy0 + 1, (y + 1) * h / cell);
+            for (int x = 0; x < cell; x++) {
+                int sx0 = x * w / cell, sx1 = std::max(sx0 + 1, (x + 1) * w / cell);
+                unsigned sum[4] = {0, 0, 0, 0};
+                for (int sy = sy0; sy < sy1; sy++)
+                    for (int sx = sx0; sx < sx1; sx++)
+                        for (int k = 0; k < 4; k++) sum[k] += image[(sy * w + sx) * 4 + k];
+                unsigned n = unsigned((sy1 - sy0) * (sx1 - sx0));
+                for (int k = 0; k < 4; k++)
+                    sheet[((oy + y) * sheetSize + (ox + x)) * 4 + k] = (unsigned char)(sum[k] / n);
+            }
+        }
+    }
+};
+
+#endif // TILEMAP_LAYER_HPP
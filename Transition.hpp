@@ -0,0 +1,59 @@
+#ifndef TRANSITION_HPP
+#define TRANSITION_HPP
+
+#include <algorithm>
+
+// ---------- TRANSITION ----------
+// Dissolvenza in nero tra due livelli guidata dal tempo del frame: fade out,
+// cambio livello a schermo nero, fade in. Non blocca mai il loop.
+struct Transition {
+    enum Phase { IDLE, FADE_OUT, FADE_IN };
+
+    Phase phase = IDLE;
+    float timer = 0.0f;
+    float fadeOutTime, fadeInTime;  // durate in secondi
+
+    // destinazione, applicata a metà transizione
+    int targetLevel = -1;
+    float targetX = 0.0f, targetY = 0.0f;
+
+    Transition(float fadeOut, float fadeIn) : fadeOutTime(fadeOut), fadeInTime(fadeIn) {}
+
+    bool active() const { return phase != IDLE; }
+
+    void start(int level, float x, float y) {
+        if (active()) return;
+        phase = FADE_OUT;
+        timer = 0.0f;
+        targetLevel = level;
+        targetX = x;
+        targetY = y;
+    }
+
+    // Avanza di dt secondi; restituisce true nel frame in cui va fatto il cambio di livello
+    bool update(float dt) {
+        if (phase == IDLE) return false;
+        timer += dt;
+        if (phase == FADE_OUT && timer >= fadeOutTime) {
+            phase = FADE_IN;
+            timer = 0.0f;
+            return true;
+        }
+        if (phase == FADE_IN && timer >= fadeInTime) {
+            phase = IDLE;
+            timer = 0.0f;
+        }
+        return false;
+    }
+
+    // Opacità del velo nero (0 = scena visibile, 1 = nero)
+    float alpha() const {
+        switch (phase) {
+            case FADE_OUT: return fadeOutTime > 0.0f ? std::min(timer / fadeOutTime, 1.0f) : 1.0f;
+            case FADE_IN:  return fadeInTime  > 0.0f ? 1.0f - std::min(timer / fadeInTime, 1.0f) : 0.0f;
+            default:       return 0.0f;
+        }
+    }
+};
+
+#endif // TRANSITION_HPP
@@ -0,0 +1,42 @@
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include <atomic>
+#include <cstdint>
+
+// ---------- TRIPLE BUFFER ----------
+// Scambio lock-free tra un produttore e un consumatore: il produttore scrive sempre
+// in un proprio slot e lo pubblica con uno scambio atomico, il consumatore prende
+// l'ultimo slot pubblicato. Nessuno dei due aspetta mai l'altro; gli stati intermedi
+// che il consumatore non ha fatto in tempo a leggere vengono semplicemente saltati.
+template <typename T>
+class TripleBuffer {
+public:
+    // Slot del produttore (da riempire prima di publish)
+    T& writeBuffer() { return slots[back]; }
+
+    void publish() {
+        back = middle.exchange(uint8_t(back | FRESH), std::memory_order_acq_rel) & INDEX;
+    }
+
+    // true se c'è uno stato pubblicato non ancora letto
+    bool hasNew() const {
+        return (middle.load(std::memory_order_acquire) & FRESH) != 0;
+    }
+
+    // Ultimo stato pubblicato; resta valido fino alla prossima chiamata di read()
+    const T& read() {
+        if (hasNew()) front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        return slots[front];
+    }
+
+private:
+    enum : uint8_t { INDEX = 3, FRESH = 4 };
+
+    T slots[3];
+    uint8_t back = 0;                 // solo produttore
+    uint8_t front = 1;                // solo consumatore
+    std::atomic<uint8_t> middle{2};   // slot condiviso (+ bit FRESH)
+};
+
+#endif // TRIPLE_BUFFER_HPP
@@ -33,5 +33,63 @@ constexpr float ASPECT_RATIO = float(WIDTH) / float(HEIGHT);
 #define GRID_SIZE 16
 #define VSync false
 #define HZ 60.0
+#define TARGET_FPS 144.0        // frame di rendering al secondo senza VSync (0 = illimitato)
+#define FRAME_SPIN_MARGIN 0.002 // secondi finali di attesa fatti in spin invece che in sleep
+#define MAX_FRAMES_IN_FLIGHT 2  // frame in coda alla GPU prima che la CPU attenda (fence, 0 = nessun limite)
+#define LOGIC_THREAD true       // logica su un thread dedicato (snapshot in triple buffer)
+
+// Frequenze dei sottosistemi della logica (tick al secondo, dentro il passo base a HZ)
+#define MOVEMENT_HZ HZ          // movimento e input del player (l'interpolazione assume HZ)
+#define ANIMATION_HZ 20.0       // frame delle entità
+#define PORTAL_HZ 20.0          // controllo dei portali
+#define IDLE_SKIP true          // niente rendering se lo snapshot non cambia: si attendono eventi o la prossima animazione
+#define IDLE_MAX_WAIT 1.0       // secondi massimi di attesa di un frame inattivo
+#define LATENCY_HISTOGRAM_FILE "latency_histogram.csv" // latenze input -> schermo esportate all'uscita ("" = nessuna)
+
+// Risoluzione interna dinamica: la scena si disegna in un target ridotto se i frame sforano il budget
+#define DYNAMIC_RESOLUTION true
+#define DYNAMIC_RESOLUTION_MIN_SCALE 0.5f // scala minima rispetto alla finestra
+#define DYNAMIC_RESOLUTION_LINEAR false   // ingrandimento: false = nearest (pixel art), true = lineare
+
+// Dissolvenza dei portali (secondi)
+#define PORTAL_FADE_OUT 0.2f
+#define PORTAL_FADE_IN 0.2f
+
+// Atlas delle texture (tile, decorazioni, mobili)
+#define TEXTURE_ATLAS true
+#define ATLAS_PAGE_SIZE 2048 // lato massimo di una pagina (limitato da GL_MAX_TEXTURE_SIZE)
+#define ATLAS_PADDING 4      // pixel di bordo attorno a ogni regione (limita anche i livelli di mipmap)
+#define ATLAS_MAX_SPAN 1     // tile coperti al massimo da una texture dell'atlas (per la riduzione)
+
+// Texture ridotte alla dimensione a schermo (WIDTH/HEIGHT e GRID_SIZE) con mipmap
+#define TEXTURE_DOWNSCALE true
+
+// Decodifica delle texture fuori dall'atlas su thread worker, upload via PBO (segnaposto nel frattempo)
+#define ASYNC_TEXTURES true
+#define TEXTURE_DECODE_THREADS 0       // worker di decodifica (0 = core disponibili - 1)
+#define TEXTURE_UPLOAD_BUDGET 0.002    // secondi per frame dedicati agli upload (almeno una texture)
+#define LEVEL_LOAD_THREADS 0           // worker per il parsing dei livelli all'avvio (0 = core disponibili - 1)
+
+// Livelli letti al primo accesso e scaricati (LRU, con le texture non più usate) oltre il limite
+#define LAZY_LEVELS true
+#define LEVEL_MEMORY_CAP (4u << 20)    // byte stimati di livelli residenti
+
+// Livelli compilati da levelc (.lvlb accanto al .txt): usati se non più vecchi del testo
+#define COMPILED_LEVELS true
+
+// Pacchetto unico di texture e livelli (assetpack); gli asset che non contiene si leggono dai file sciolti
+#define ASSET_PACK "assets.pak" // "" = solo file sciolti
+#define ASSET_PACK_RELEASE false // false = un file sciolto più recente del pacchetto vince (sviluppo)
+
+// Cache del background statico in un FBO (display list su GL 2.1 senza FBO)
+#define BACKGROUND_CACHE true
+#define BACKGROUND_CACHE_DECORATIONS false // true = anche decorazioni e portali (restano sempre dietro al player)
+
+// Sprite (player, entità, decorazioni) con glDrawArraysInstanced; false = batch espanso sulla CPU
+#define SPRITE_INSTANCING true
+
+// Background con shader + texture indice (un quad per tutta la mappa); senza GLSL resta il TileLayer
+#define TILEMAP_SHADER true
+#define TILEMAP_CELL_SIZE 64 // lato in pixel di ogni tile nel foglio dello shader
 
 #endif // VARIABLE_HPP
@@ -0,0 +1,133 @@
+// ---------- ASSETPACK ----------
+// Crea il pacchetto asset (AssetPack.hpp) da file e cartelle (ricorsive). I nomi delle
+// voci sono i path così come li usa il gioco ("texture/block/erba.png"): va lanciato
+// dalla cartella del gioco. Ogni file viene compresso solo se si risparmia almeno 1/8.
+//
+// uso: assetpack <pacchetto> <file o cartella>...   (es. assetpack assets.pak texture levels)
+#include "AssetPack.hpp"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+    namespace fs = std::filesystem;
+
+    struct Input {
+        std::string name;   // nome della voce (AssetPack::NormalizeName)
+        fs::path path;
+    };
+
+    void collect(const fs::path& root, std::vector<Input>& inputs) {
+        auto add = [&inputs](const fs::path& path) {
+            if (path.extension() == ".tmp") return; // scritture a metà (levelc)
+            inputs.push_back(Input{AssetPack::NormalizeName(path.lexically_normal().generic_string()), path});
+        };
+        if (fs::is_regular_file(root)) {
+            add(root);
+            return;
+        }
+        for (const auto& entry : fs::recursive_directory_iterator(root)) {
+            if (entry.is_regular_file()) add(entry.path());
+        }
+    }
+
+    bool readFile(const fs::path& path, std::vector<unsigned char>& bytes) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return false;
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        return !in.bad();
+    }
+
+    void pad(std::vector<unsigned char>& out, size_t alignment) {
+        while (out.size() % alignment) out.push_back(0);
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "uso: " << argv[0] << " <pacchetto> <file o cartella>..." << std::endl;
+        return 2;
+    }
+    const std::string target = argv[1];
+
+    std::vector<Input> inputs;
+    try {
+        for (int i = 2; i < argc; i++) collect(argv[i], inputs);
+    } catch (const fs::filesystem_error& e) {
+        std::cerr << "Errore: " << e.what() << std::endl;
+        return 1;
+    }
+    // ordine dei byte del nome: quello della ricerca binaria in AssetPack::Find
+    std::sort(inputs.begin(), inputs.end(), [](const Input& a, const Input& b) { return a.name < b.name; });
+    inputs.erase(std::unique(inputs.begin(), inputs.end(), [](const Input& a, const Input& b) { return a.name == b.name; }),
+                 inputs.end());
+
+    std::vector<unsigned char> out(sizeof(AssetPack::Header));
+    std::vector<AssetPack::Entry> entries;
+    std::string names;
+    uint64_t rawBytes = 0;
+    int compressed = 0;
+    for (const Input& input : inputs) {
+        std::vector<unsigned char> bytes;
+        if (!readFile(input.path, bytes)) {
+            std::cerr << "Errore: impossibile leggere " << input.path.string() << std::endl;
+            return 1;
+        }
+        AssetPack::Entry e{};
+        e.size = bytes.size();
+        e.nameOffset = uint32_t(names.size());
+        e.nameLength = uint32_t(input.name.size());
+        names += input.name;
+
+        std::vector<unsigned char> packed = AssetPack::Compress(bytes.data(), bytes.size());
+        if (packed.size() < bytes.size() - bytes.size() / 8) {
+            e.compression = AssetPack::LZ;
+            bytes.swap(packed);
+            compressed++;
+        } else {
+            e.compression = AssetPack::STORED;
+        }
+        pad(out, AssetPack::DATA_ALIGN);
+        e.dataOffset = out.size();
+        e.storedSize = bytes.size();
+        out.insert(out.end(), bytes.begin(), bytes.end());
+        entries.push_back(e);
+        rawBytes += e.size;
+    }
+
+    AssetPack::Header h{};
+    std::memcpy(h.magic, AssetPack::MAGIC, 4);
+    h.version = AssetPack::VERSION;
+    h.endianTag = AssetPack::ENDIAN_TAG;
+    h.entryCount = uint32_t(entries.size());
+    pad(out, alignof(AssetPack::Entry));
+    h.tocOffset = out.size();
+    const unsigned char* toc = reinterpret_cast<const unsigned char*>(entries.data());
+    out.insert(out.end(), toc, toc + entries.size() * sizeof(AssetPack::Entry));
+    h.namesOffset = out.size();
+    h.namesBytes = names.size();
+    out.insert(out.end(), names.begin(), names.end());
+    std::memcpy(out.data(), &h, sizeof(h));
+
+    // file temporaneo e rinomina: il gioco non apre mai un pacchetto a metà
+    const std::string temp = target + ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(out.data()), std::streamsize(out.size()));
+        if (!file) {
+            std::cerr << "Errore: impossibile scrivere " << temp << std::endl;
+            return 1;
+        }
+    }
+    std::error_code error;
+    fs::rename(temp, target, error);
+    if (error) {
+        std::cerr << "Errore: impossibile scrivere " << target << ": " << error.message() << std::endl;
+        return 1;
+    }
+    std::cout << target << ": " << entries.size() << " file (" << compressed << " compressi), "
+              << rawBytes << " -> " << out.size() << " byte" << std::endl;
+    return 0;
+}
@@ -0,0 +1,157 @@
+// ---------- LEVELC ----------
+// Compilatore dei livelli: ogni levels/*.txt diventa un levels/*.lvlb (LevelFormat.hpp)
+// con hitbox, path delle texture e destinazioni dei portali già risolte.
+// Il .txt resta il formato di lavoro; il gioco usa il .lvlb se non è più vecchio.
+//
+// uso: levelc [cartella]   (default: levels)
+#include "GameManager.hpp"
+#include <map>
+
+namespace {
+
+    // Record e tabella delle stringhe del livello in costruzione
+    struct LevelWriter {
+        std::vector<char> strings;
+        std::map<std::string, uint32_t> stringOffsets;
+        std::vector<uint32_t> textures;
+        std::map<std::string, uint32_t> textureIndices;
+
+        uint32_t addString(const std::string& s) {
+            auto it = stringOffsets.find(s);
+            if (it != stringOffsets.end()) return it->second;
+            uint32_t offset = uint32_t(strings.size());
+            strings.insert(strings.end(), s.begin(), s.end());
+            strings.push_back('\0');
+            stringOffsets.insert({s, offset});
+            return offset;
+        }
+
+        uint32_t addTexture(const std::string& path) {
+            auto it = textureIndices.find(path);
+            if (it != textureIndices.end()) return it->second;
+            uint32_t index = uint32_t(textures.size());
+            textures.push_back(addString(path));
+            textureIndices.insert({path, index});
+            return index;
+        }
+    };
+
+    // Accoda una sezione allineata a 4 byte e ne restituisce la posizione
+    template <typename T>
+    LevelFormat::Section appendSection(std::vector<unsigned char>& out, const std::vector<T>& records) {
+        while (out.size() % 4) out.push_back(0);
+        LevelFormat::Section section{uint32_t(out.size()), uint32_t(records.size())};
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(records.data());
+        out.insert(out.end(), bytes, bytes + records.size() * sizeof(T));
+        return section;
+    }
+
+    LevelFormat::DecorationRecord decorationRecord(LevelWriter& writer, const Decoration& dec) {
+        return LevelFormat::DecorationRecord{writer.addTexture(dec.texturePath), dec.x, dec.y, dec.width, dec.height,
+                                             dec.render_height_y};
+    }
+
+    std::vector<unsigned char> compileLevel(const Level& lvl, const std::map<std::string, int>& levelIds) {
+        using namespace LevelFormat;
+        LevelWriter writer;
+
+        std::vector<TileRecord> tiles;
+        tiles.reserve(lvl.tiles.size());
+        for (const Tile& tile : lvl.tiles) {
+            tiles.push_back(TileRecord{tile.id, tile.texturePath.empty() ? NONE : writer.addTexture(tile.texturePath)});
+        }
+
+        std::vector<DecorationRecord> decorations;
+        for (const Decoration& dec : lvl.decorations) decorations.push_back(decorationRecord(writer, dec));
+
+        std::vector<PortalRecord> portals;
+        for (const Portal& port : lvl.portals) {
+            auto it = levelIds.find(port.path_new_level);
+            if (it == levelIds.end()) std::cerr << "  attenzione: destinazione inesistente " << port.path_new_level << std::endl;
+            portals.push_back(PortalRecord{decorationRecord(writer, port), writer.addString(port.path_new_level),
+                                           it != levelIds.end() ? uint32_t(it->second) : NONE,
+                                           port.new_player_x_cord, port.new_player_y_cord, port.render_height_x});
+        }
+
+        std::vector<EntityRecord> entities;
+        for (const Entity& ent : lvl.entity) {
+            entities.push_back(EntityRecord{writer.addTexture(ent.texturePath), ent.x, ent.y, ent.width, ent.height,
+                                            ent.scaleX, ent.scaleY, ent.frameWidth, ent.frameHeight,
+                                            ent.framesPerRow, ent.framesPerCol, ent.currentFrameX, ent.stop_frame_y,
+                                            ent.render_height_y});
+        }
+
+        std::vector<HitboxRecord> hitboxes;
+        for (const Hitbox& hb : lvl.hitboxes) hitboxes.push_back(HitboxRecord{hb.x0, hb.y0, hb.x1, hb.y1});
+
+        Header h{};
+        std::memcpy(h.magic, MAGIC, 4);
+        h.version = VERSION;
+        h.endianTag = ENDIAN_TAG;
+        h.width = lvl.width;
+        h.height = lvl.height;
+        h.gridSize = GRID_SIZE;
+        h.parserRevision = PARSER_REVISION;
+        h.levelCount = uint32_t(levelIds.size());
+
+        std::vector<unsigned char> out(sizeof(Header));
+        h.tiles = appendSection(out, tiles);
+        h.decorations = appendSection(out, decorations);
+        h.portals = appendSection(out, portals);
+        h.entities = appendSection(out, entities);
+        h.hitboxes = appendSection(out, hitboxes);
+        h.textures = appendSection(out, writer.textures);
+        writer.addString(""); // la tabella non è mai vuota
+        h.strings = appendSection(out, writer.strings);
+        std::memcpy(out.data(), &h, sizeof(h));
+        return out;
+    }
+
+    // Scrive su un file temporaneo e lo rinomina: il gioco non vede mai un .lvlb a metà
+    bool writeFile(const std::string& path, const std::vector<unsigned char>& bytes) {
+        const std::string temp = path + ".tmp";
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            if (!out) return false;
+            out.write(reinterpret_cast<const char*>(bytes.data()), std::streamsize(bytes.size()));
+            if (!out) return false;
+        }
+        std::error_code error;
+        std::filesystem::rename(temp, path, error);
+        return !error;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::string folder = argc > 1 ? argv[1] : "levels";
+
+    // stessi id del gioco (listLevelPaths), così gli indici dei portali coincidono
+    std::vector<std::string> paths = listLevelPaths(folder);
+    std::map<std::string, int> levelIds;
+    for (size_t i = 0; i < paths.size(); i++) levelIds.insert({paths[i], int(i)});
+
+    int failures = 0, compiled = 0;
+    for (const std::string& path : paths) {
+        if (!std::filesystem::exists(path)) continue; // solo il .lvlb: niente da compilare
+
+        Level lvl(GRID_SIZE, GRID_SIZE);
+        std::ostringstream log;
+        if (!parseLevelFile(path, lvl, log)) {
+            std::cerr << "Errore: impossibile aprire " << path << std::endl;
+            failures++;
+            continue;
+        }
+        std::vector<unsigned char> bytes = compileLevel(lvl, levelIds);
+        const std::string target = compiledLevelPath(path);
+        if (!writeFile(target, bytes)) {
+            std::cerr << "Errore: impossibile scrivere " << target << std::endl;
+            failures++;
+            continue;
+        }
+        std::cout << path << " -> " << target << " (" << bytes.size() << " byte)" << std::endl;
+        compiled++;
+    }
+    std::cout << compiled << " livelli compilati" << std::endl;
+    return failures ? 1 : 0;
+}
@@ -6,7 +6,41 @@
 #include "TextureLoader.hpp"
 #include "GameManager.hpp"
 #include "Variable.hpp"
+#include "FrameScheduler.hpp"
+#include "Simulation.hpp"
+#include "InputQueue.hpp"
+#include "DynamicResolution.hpp"
+#include "FrameFences.hpp"
+#include "LatencyHistogram.hpp"
+#include <string>
+
+// Callback GLFW: trasforma i tasti WASD in eventi con timestamp per la logica
+static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    (void)scancode; (void)mods;
+    if (action == GLFW_REPEAT) return; // interessano solo le transizioni
+    InputKey inputKey;
+    switch (key) {
+        case GLFW_KEY_W: inputKey = KEY_UP;    break;
+        case GLFW_KEY_S: inputKey = KEY_DOWN;  break;
+        case GLFW_KEY_A: inputKey = KEY_LEFT;  break;
+        case GLFW_KEY_D: inputKey = KEY_RIGHT; break;
+        default: return;
+    }
+    InputQueue* queue = static_cast<InputQueue*>(glfwGetWindowUserPointer(window));
+    queue->push(InputEvent{SteadyTime(), inputKey, action == GLFW_PRESS});
+}
 
+// Eventi della finestra che invalidano l'immagine a schermo (frame inattivi)
+static bool windowDirty = true;
+static bool windowIconified = false;
+
+static void refreshCallback(GLFWwindow*) { windowDirty = true; }
+static void framebufferSizeCallback(GLFWwindow*, int, int) { windowDirty = true; }
+static void focusCallback(GLFWwindow*, int) { windowDirty = true; }
+static void iconifyCallback(GLFWwindow*, int iconified) {
+    windowIconified = iconified == GLFW_TRUE;
+    windowDirty = true;
+}
 
 int main(int argc, char* argv[]) {
     srand(time(nullptr));
@@ -26,10 +60,10 @@ int main(int argc, char* argv[]) {
 
     glfwMakeContextCurrent(window);
     glfwSwapInterval(VSync); // 0 = nessun V-Sync, 1 = V-Sync attivo
-    glEnable(GL_TEXTURE_2D); //Abilita la texturizzazione
+    TextureRender::Enable(GL_TEXTURE_2D); //Abilita la texturizzazione
     // Abilita blending per la trasparenza
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    TextureRender::Enable(GL_BLEND);
+    TextureRender::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     // 3. Inizializza GLEW
     glewExperimental = true;
@@ -51,6 +85,14 @@ int main(int argc, char* argv[]) {
     //colore sfondo
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f); //R, G, B, clear
     
+    // pacchetto asset (se c'è): texture e livelli letti da un solo file mappato
+    AssetPack::Open(ASSET_PACK);
+    // atlas delle texture statiche e foglio della tilemap (stesse immagini decodificate
+    // una volta sola), prima di caricare i livelli
+    BuildTileAtlas(TilemapLayer::BuildSheet);
+    // le altre texture si decodificano sui worker: a decodifica finita si sveglia il loop
+    TextureRender::textureStreamer.onDecoded = []() { glfwPostEmptyEvent(); };
+
     //inizializziamo il GameManager
     GameManager GameManager;
     // Carico TUTTI i livelli
@@ -58,78 +100,144 @@ int main(int argc, char* argv[]) {
     for (const auto& pair : LevelMap) {
         std::cout << pair.first << " -> " << pair.second << std::endl;
     }
-    //frame di logica
-    const double dt = 1.0 / HZ; // logica a 60Hz
-    double accumulator = 0.0;
     //timer
     double lastTime = glfwGetTime();
-    double lastInputTime = lastTime; // tempo dell'ultimo input
-    const double idleThreshold = 0.5; // secondi di inattività prima di frame 0,0
     //init fps
     int fps_counter = 0;
     double fpsTime = lastTime;
+    // limitatore di frame (con il VSync attivo ci pensa già lo swap)
+    FrameScheduler frameScheduler(VSync ? 0.0 : TARGET_FPS, FRAME_SPIN_MARGIN);
+    // limite ai frame in coda al driver (latenza deterministica)
+    FrameFences frameFences(MAX_FRAMES_IN_FLIGHT);
+    // risoluzione interna adattiva (budget: TARGET_FPS, o 60 Hz con il VSync)
+    DynamicResolution dynamicResolution(VSync ? 0.0 : TARGET_FPS, DYNAMIC_RESOLUTION_MIN_SCALE, DYNAMIC_RESOLUTION_LINEAR);
     //caricamento primo livello
-    int current_lvl;
     auto it = LevelMap.find("levels/exterior.txt");
     if (it != LevelMap.end()) {
         std::cout << "Livello iniziale trovato! path=" << it->first << "; id=" << it->second << std::endl;
-        current_lvl = it->second;
+        GameManager.currentLevel = it->second;
+        GameManager.getLevel(GameManager.currentLevel); // unico livello letto all'avvio
     } else {
         std::cerr << "Livello iniziale non esistente !" << std::endl;
         return 1;
     }
+    // input a eventi: la callback riempie la coda, la logica la svuota
+    InputQueue inputQueue;
+    glfwSetWindowUserPointer(window, &inputQueue);
+    glfwSetKeyCallback(window, keyCallback);
+    glfwSetWindowRefreshCallback(window, refreshCallback);
+    glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+    glfwSetWindowFocusCallback(window, focusCallback);
+    glfwSetWindowIconifyCallback(window, iconifyCallback);
+
+    // logica a timestep fisso (1/HZ), su un thread dedicato se LOGIC_THREAD
+    Simulation simulation(GameManager, inputQueue, 1.0 / HZ);
+    if (LOGIC_THREAD) simulation.start();
+
+    // frame inattivi: si ridisegna solo se lo snapshot visibile è cambiato
+    uint64_t renderedVersion = 0;
+    bool renderedOnce = false;
+    unsigned long idleFrames = 0;
+    // latenza dalla pressione di un tasto allo swap del frame che ne mostra l'effetto
+    LatencyHistogram inputLatency;
+
     //loop gioco
     while (!glfwWindowShouldClose(window)) {
         double currentTime = glfwGetTime();
         double frameTime = currentTime - lastTime;
         lastTime = currentTime;
-        accumulator += frameTime;
-
-        bool inputDetected = false;
-
-        // LOGICA (movimento a timestep fisso)
-        while (accumulator >= dt) {
-            const Level& lvl = GameManager.getLevel(current_lvl);
-
-            if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
-                GameManager.player.moveUp(dt, lvl);
-                inputDetected = true;
-            }
-            if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) {
-                GameManager.player.moveDown(dt, lvl);
-                inputDetected = true;
-            }
-            if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) {
-                GameManager.player.moveLeft(dt, lvl);
-                inputDetected = true;
-            }
-            if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) {
-                GameManager.player.moveRight(dt, lvl);
-                inputDetected = true;
-            }
-
-            if (inputDetected) lastInputTime = currentTime;
-            accumulator -= dt;
+
+        // INPUT: gli eventi vengono raccolti subito, prima della logica del frame
+        glfwPollEvents();
+
+        // LOGICA (nel loop solo senza thread dedicato)
+        if (!LOGIC_THREAD) simulation.advance(frameTime);
+
+        const RenderSnapshot& snapshot = simulation.latest();
+
+        // TEXTURE decodificate dai worker: upload entro il budget del frame
+        if (TextureRender::PumpTextureUploads(TEXTURE_UPLOAD_BUDGET) > 0) windowDirty = true;
+
+        // FRAME INATTIVO: stessa immagine già a schermo, si dorme fino al prossimo evento
+        // della finestra o al passo che cambierà qualcosa (animazioni, fine dell'idle)
+        // Con l'interpolazione l'immagine cambia tra un passo e l'altro anche a visualVersion ferma
+        bool interpolating = snapshot.prevPlayerX != snapshot.playerX || snapshot.prevPlayerY != snapshot.playerY;
+        bool unchanged = renderedOnce && !windowDirty && snapshot.visualVersion == renderedVersion && !interpolating
+                      && !simulation.inputPending(snapshot); // l'input consumato va misurato a schermo
+        if (IDLE_SKIP && (windowIconified || unchanged) && !inputQueue.pending()
+            && !TextureRender::TextureUploadsPending()) {
+            glfwWaitEventsTimeout(windowIconified ? IDLE_MAX_WAIT : simulation.idleTimeout(snapshot));
+            idleFrames++;
+            frameScheduler.resync();
+            continue;
         }
 
-        // RENDERING
+        // RENDERING dell'ultimo snapshot pubblicato (nel target interno se la scala è < 1)
+        int framebufferWidth, framebufferHeight;
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+        if (DYNAMIC_RESOLUTION) dynamicResolution.begin(framebufferWidth, framebufferHeight);
+        else glViewport(0, 0, framebufferWidth, framebufferHeight);
         glClear(GL_COLOR_BUFFER_BIT);
-        GameManager.renderLevel(current_lvl, frameTime, (currentTime - lastInputTime < idleThreshold));
+        GameManager.render(snapshot, simulation.interpolationAlpha(snapshot));
+        if (DYNAMIC_RESOLUTION) dynamicResolution.resolve();
 
         glfwSwapBuffers(window);
-        glfwPollEvents();
+        double latency = simulation.inputPresented(snapshot, SteadyTime());
+        if (latency >= 0.0) inputLatency.add(latency);
+        frameFences.frameSubmitted(); // attende il frame di MAX_FRAMES_IN_FLIGHT - 1 frame fa
+        if (DYNAMIC_RESOLUTION) dynamicResolution.frameDone();
+        renderedVersion = snapshot.visualVersion;
+        renderedOnce = true;
+        windowDirty = false;
 
         // FPS COUNTER
         fps_counter++;
         if(currentTime - fpsTime >= 1.0){
             std::cout << "\r" << (VSync ? "(VSync: on) " : "(VSync: off) ")
-                    << "FPS: " << fps_counter << std::flush;
+                    << "FPS: " << fps_counter
+                    << " | GL state: " << TextureRender::stateStats.issued << " chiamate, "
+                    << TextureRender::stateStats.skipped << " evitate"
+                    << " | ritardo frame: " << frameScheduler.lateFrames << " in ritardo, medio "
+                    << frameScheduler.averageMiss() * 1000.0 << " ms, max "
+                    << frameScheduler.maxMiss * 1000.0 << " ms"
+                    << " | attesa GPU: media " << frameFences.averageWait() * 1000.0 << " ms, max "
+                    << frameFences.maxWait * 1000.0 << " ms"
+                    << " | attese inattive: " << idleFrames
+                    << " | scala: " << dynamicResolution.scale
+                    << " | latenza input: media " << inputLatency.average() * 1000.0 << " ms" << std::flush;
             fps_counter = 0;
+            TextureRender::stateStats = TextureRender::GLStateStats();
+            frameScheduler.resetStats();
+            frameFences.resetStats();
+            idleFrames = 0;
             fpsTime = currentTime;
         }
+
+        // attesa fino al prossimo frame (sleep + spin)
+        frameScheduler.waitForNextFrame();
+    }
+
+    // istogramma delle latenze, con la modalità di pacing per confrontare le configurazioni
+    if (std::string(LATENCY_HISTOGRAM_FILE).size() && inputLatency.samples) {
+        std::string mode = std::string("VSync=") + (VSync ? "on" : "off")
+                         + " TARGET_FPS=" + std::to_string(TARGET_FPS)
+                         + " MAX_FRAMES_IN_FLIGHT=" + std::to_string(MAX_FRAMES_IN_FLIGHT)
+                         + " LOGIC_THREAD=" + (LOGIC_THREAD ? "on" : "off")
+                         + " HZ=" + std::to_string(HZ);
+        if (inputLatency.exportCsv(LATENCY_HISTOGRAM_FILE, mode))
+            std::cout << "\nLatenze input salvate in " << LATENCY_HISTOGRAM_FILE << std::endl;
+        else
+            std::cerr << "\nImpossibile scrivere " << LATENCY_HISTOGRAM_FILE << std::endl;
     }
 
     // 5. Pulizia
+    simulation.stop();
+    dynamicResolution.release();
+    dynamicResolution.releaseQueries();
+    frameFences.release();
+    TextureRender::StopTextureStreaming();
+    TilemapLayer::ReleaseSheet();
+    AssetPack::Close(); // dopo i worker che decodificano dal pacchetto
     glfwDestroyWindow(window);
     glfwTerminate();
     return 0;